@@ -0,0 +1,218 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <ostream>
+#include <random>
+#include <streambuf>
+#include <vector>
+
+#include <dag/dag.hpp>
+
+// Benchmarks of the core operations over generated graph shapes. Every shape yields edges from a
+// lower to a higher index, so insertion never fails and each run does the same work. Sizes are the
+// benchmark argument (node count); StaticDAG runs are capped by its compile-time pools.
+//
+// Track results over time with --benchmark_out=<file> --benchmark_out_format=json (or the
+// dag-bench-json target) and compare two files with Google Benchmark's tools/compare.py.
+
+namespace
+{
+    using namespace dag;
+
+    constexpr size_t staticNodes = 4096;
+    constexpr size_t staticEdges = 16 * staticNodes;
+    using Static = StaticDAG<void, staticNodes, staticEdges>;
+    using Dynamic = DynamicDAG<void>;
+
+    // i -> i + 1: one long path, the worst case for depth.
+    struct Chain {
+        static std::vector<EdgeSpec> edges(DagIndexType n) {
+            std::vector<EdgeSpec> out;
+            for (DagIndexType i = 0; i + 1 < n; i++) out.push_back({ i, i + 1 });
+            return out;
+        }
+    };
+
+    // 0 -> everything: one node with a huge out-degree.
+    struct FanOut {
+        static std::vector<EdgeSpec> edges(DagIndexType n) {
+            std::vector<EdgeSpec> out;
+            for (DagIndexType i = 1; i < n; i++) out.push_back({ 0, i });
+            return out;
+        }
+    };
+
+    // Layers of 64 nodes, each node linked to 4 random nodes of the next layer.
+    struct Layered {
+        static std::vector<EdgeSpec> edges(DagIndexType n) {
+            constexpr DagIndexType width = 64;
+            std::mt19937_64 rng(42);
+            std::vector<EdgeSpec> out;
+            for (DagIndexType i = 0; i + width < n; i++) {
+                const DagIndexType next = (i / width + 1) * width;
+                const DagIndexType span = std::min(width, n - next);
+                for (int k = 0; k < 4; k++) out.push_back({ i, next + rng() % span });
+            }
+            return out;
+        }
+    };
+
+    // 16 edges per node between random pairs, forward in index order.
+    struct Dense {
+        static std::vector<EdgeSpec> edges(DagIndexType n) {
+            std::mt19937_64 rng(7);
+            std::vector<EdgeSpec> out;
+            while (out.size() < 16 * (n - 1)) {
+                DagIndexType a = rng() % n, b = rng() % n;
+                if (a == b) continue;
+                if (a > b) std::swap(a, b);
+                out.push_back({ a, b });
+            }
+            return out;
+        }
+    };
+
+    template<typename DAG>
+    std::unique_ptr<DAG> makeNodes(DagIndexType n) {
+        auto dag = std::make_unique<DAG>();
+        for (DagIndexType i = 0; i < n; i++) dag->addNode();
+        return dag;
+    }
+
+    template<typename DAG, typename Shape>
+    std::unique_ptr<DAG> makeGraph(DagIndexType n) {
+        auto dag = makeNodes<DAG>(n);
+        for (auto& edge : Shape::edges(n)) dag->addEdgeUnchecked(edge.from, edge.to, edge.flags);
+        return dag;
+    }
+
+    // Discards everything written to it, so export benchmarks measure formatting only.
+    struct NullBuffer : std::streambuf {
+        std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+        int overflow(int c) override { return c; }
+    };
+
+    template<typename DAG, typename Shape>
+    void addEdgeChecked(benchmark::State& state) {
+        const DagIndexType n = state.range(0);
+        const auto edges = Shape::edges(n);
+        for (auto _ : state) {
+            state.PauseTiming();
+            auto dag = makeNodes<DAG>(n);
+            state.ResumeTiming();
+            for (auto& edge : edges) benchmark::DoNotOptimize(dag->addEdge(edge.from, edge.to));
+        }
+        state.SetItemsProcessed(state.iterations() * edges.size());
+    }
+
+    template<typename DAG, typename Shape>
+    void addEdgesBatch(benchmark::State& state) {
+        const DagIndexType n = state.range(0);
+        const auto edges = Shape::edges(n);
+        for (auto _ : state) {
+            state.PauseTiming();
+            auto dag = makeNodes<DAG>(n);
+            state.ResumeTiming();
+            benchmark::DoNotOptimize(dag->addEdges(edges));
+        }
+        state.SetItemsProcessed(state.iterations() * edges.size());
+    }
+
+    template<typename DAG, typename Shape>
+    void reachable(benchmark::State& state) {
+        const DagIndexType n = state.range(0);
+        auto dag = makeGraph<DAG, Shape>(n);
+        std::mt19937_64 rng(1);
+        std::vector<std::pair<DagIndexType, DagIndexType>> queries(256);
+        for (auto& [from, to] : queries) { from = rng() % n; to = rng() % n; }
+
+        Workspace ws;
+        size_t q = 0;
+        for (auto _ : state) {
+            auto [from, to] = queries[q++ % queries.size()];
+            benchmark::DoNotOptimize(dag->reachable(from, to, ws));
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template<typename DAG, typename Shape>
+    void topologicalSort(benchmark::State& state) {
+        const DagIndexType n = state.range(0);
+        auto dag = makeGraph<DAG, Shape>(n);
+        Workspace ws;
+        for (auto _ : state) benchmark::DoNotOptimize(dag->topologicalSort(ws).data());
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+
+    template<typename DAG, typename Shape>
+    void transitiveReduction(benchmark::State& state) {
+        const DagIndexType n = state.range(0);
+        auto dag = makeGraph<DAG, Shape>(n);
+        Workspace ws;
+        decltype(dag->transitivelyReducePerNode()) reduced{};
+        for (auto _ : state) {
+            dag->transitivelyReducePerNode(reduced, ws);
+            benchmark::DoNotOptimize(reduced.data());
+        }
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+
+    template<typename DAG, typename Shape>
+    void exportDot(benchmark::State& state) {
+        const DagIndexType n = state.range(0);
+        auto dag = makeGraph<DAG, Shape>(n);
+        NullBuffer sink;
+        std::ostream out(&sink);
+        for (auto _ : state) exportToDot(*dag, out);
+        state.SetItemsProcessed(state.iterations() * n);
+    }
+
+    // Registers `bench` for both containers and all shapes; StaticDAG only up to its pool size.
+    template<template<typename, typename> class Bench>
+    void registerAll(const char* name, std::vector<int64_t> sizes) {
+        auto add = [&](const char* container, const char* shape, auto fn, bool isStatic) {
+            auto* b = benchmark::RegisterBenchmark((std::string(name) + "/" + container + "/" + shape).c_str(), fn);
+            for (auto size : sizes) {
+                if (!isStatic || size <= int64_t(staticNodes)) b->Arg(size);
+            }
+        };
+        add("Static", "Chain", Bench<Static, Chain>::run, true);
+        add("Static", "FanOut", Bench<Static, FanOut>::run, true);
+        add("Static", "Layered", Bench<Static, Layered>::run, true);
+        add("Static", "Dense", Bench<Static, Dense>::run, true);
+        add("Dynamic", "Chain", Bench<Dynamic, Chain>::run, false);
+        add("Dynamic", "FanOut", Bench<Dynamic, FanOut>::run, false);
+        add("Dynamic", "Layered", Bench<Dynamic, Layered>::run, false);
+        add("Dynamic", "Dense", Bench<Dynamic, Dense>::run, false);
+    }
+
+#define DAG_BENCH(fn) \
+    template<typename DAG, typename Shape> struct fn##Bench { \
+        static void run(benchmark::State& state) { fn<DAG, Shape>(state); } \
+    }
+
+    DAG_BENCH(addEdgeChecked);
+    DAG_BENCH(addEdgesBatch);
+    DAG_BENCH(reachable);
+    DAG_BENCH(topologicalSort);
+    DAG_BENCH(transitiveReduction);
+    DAG_BENCH(exportDot);
+
+#undef DAG_BENCH
+}
+
+int main(int argc, char** argv) {
+    const std::vector<int64_t> sizes{ 1 << 10, 1 << 12, 1 << 14 };
+    registerAll<addEdgeCheckedBench>("addEdge", { 1 << 10, 1 << 12 }); // a DFS per edge: quadratic on Dense
+    registerAll<addEdgesBatchBench>("addEdges", sizes);
+    registerAll<reachableBench>("reachable", sizes);
+    registerAll<topologicalSortBench>("topologicalSort", sizes);
+    registerAll<transitiveReductionBench>("transitivelyReducePerNode", sizes);
+    registerAll<exportDotBench>("exportToDot", sizes);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "dag.hpp"
+
+namespace dag
+{
+
+    // A DynamicDAG shared read-copy-update style: readers query immutable CsrDAG snapshots without
+    // locking, and publish() freezes the writer's private graph into the next one. Writers serialize.
+    template<typename T>
+    class ConcurrentDAG {
+    public:
+        using Graph = DynamicDAG<T>;
+        using Snapshot = CsrDAG<T>;
+
+        ConcurrentDAG() : current(std::make_shared<const Snapshot>()) {}
+
+        // Starts from an existing graph and publishes it as the first snapshot.
+        explicit ConcurrentDAG(Graph graph) : writer(std::move(graph)) { publish(); }
+
+        ConcurrentDAG(const ConcurrentDAG&) = delete;
+        ConcurrentDAG& operator=(const ConcurrentDAG&) = delete;
+
+        // === Readers (any thread) ===
+
+        std::shared_ptr<const Snapshot> snapshot() const { return current.load(std::memory_order_acquire); }
+
+        // Number of publish() calls so far; the snapshot returned after it is that version.
+        uint64_t version() const { return published.load(std::memory_order_acquire); }
+
+        // === Writer ===
+
+        // Freezes the writer's graph into the current snapshot, with predecessor arrays if
+        // buildSnapshotPredecessors(true).
+        uint64_t publish() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return publishLocked();
+        }
+
+        void buildSnapshotPredecessors(bool enabled) {
+            std::lock_guard<std::mutex> lock(mutex);
+            withPredecessors = enabled;
+        }
+
+        // Runs fn(graph) on the writer's graph, then publishes. Returns what fn returns.
+        template<typename Fn>
+        auto update(Fn&& fn) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if constexpr (std::is_void_v<decltype(fn(writer))>) {
+                fn(writer);
+                publishLocked();
+            }
+            else {
+                auto result = fn(writer);
+                publishLocked();
+                return result;
+            }
+        }
+
+        // Single edits on the writer's graph, not visible to readers before the next publish().
+        // Failures are reported as by DynamicDAG (lastError()).
+        template<typename... Data>
+        DagIndexType addNode(Data&&... data) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return writer.addNode(std::forward<Data>(data)...);
+        }
+
+        template<typename... Args>
+        DagIndexType emplaceNode(Args&&... args) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return writer.emplaceNode(std::forward<Args>(args)...);
+        }
+
+        bool addEdge(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return writer.addEdge(from, to, flags);
+        }
+
+        bool addEdges(std::span<const EdgeSpec> batch, std::vector<DagIndexType>* cycle = nullptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return writer.addEdges(batch, cycle);
+        }
+
+        bool removeEdge(DagIndexType from, DagIndexType to) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return writer.removeEdge(from, to);
+        }
+
+        bool removeNode(DagIndexType node) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return writer.removeNode(node);
+        }
+
+        const char* lastError() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return writer.lastError;
+        }
+
+    private:
+        mutable std::mutex mutex; // guards `writer` and `withPredecessors`
+        Graph writer;
+        bool withPredecessors = false;
+        std::atomic<std::shared_ptr<const Snapshot>> current;
+        std::atomic<uint64_t> published{ 0 };
+
+        uint64_t publishLocked() {
+            auto next = std::make_shared<Snapshot>(freeze(writer));
+            if (withPredecessors) next->buildPredecessors();
+            current.store(std::move(next), std::memory_order_release);
+            return published.fetch_add(1, std::memory_order_acq_rel) + 1;
+        }
+    };
+
+} // namespace dag
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "dag.hpp"
+
+namespace dag
+{
+
+    // Lazily started coroutine producing no value; rethrows to its awaiter what escaped its body.
+    class Task {
+    public:
+        struct promise_type {
+            std::coroutine_handle<> continuation = std::noop_coroutine();
+            std::exception_ptr error;
+
+            Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            auto final_suspend() noexcept {
+                struct Resume {
+                    bool await_ready() noexcept { return false; }
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> self) noexcept {
+                        return self.promise().continuation;
+                    }
+                    void await_resume() noexcept {}
+                };
+                return Resume{};
+            }
+
+            void return_void() {}
+            void unhandled_exception() { error = std::current_exception(); }
+        };
+
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+        ~Task() { if (handle) handle.destroy(); }
+
+        bool await_ready() const noexcept { return !handle || handle.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+            handle.promise().continuation = awaiting;
+            return handle;
+        }
+
+        void await_resume() {
+            if (handle && handle.promise().error) std::rethrow_exception(handle.promise().error);
+        }
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    namespace detail
+    {
+        // Fire-and-forget coroutine: starts at once and frees itself when done. Bodies catch their own
+        // exceptions.
+        struct Detached {
+            struct promise_type {
+                Detached get_return_object() noexcept { return {}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept { std::terminate(); }
+            };
+        };
+
+        template<typename Run>
+        Detached runNode(Run* run, DagIndexType node) {
+            std::exception_ptr error;
+            try {
+                co_await run->invoke(node);
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+            run->complete(node, error);
+        }
+
+        // State of one runAsync() call. Ready nodes wait on a stack, which only one thread drains at a
+        // time, so synchronous chains do not nest.
+        template<typename DAG, typename Fn, typename Filter>
+        class AsyncRun {
+        public:
+            AsyncRun(const DAG& dag, Fn& fn, Filter& edgeFilter, size_t limit)
+                : dag(dag), fn(fn), edgeFilter(edgeFilter), limit(limit) {}
+
+            bool await_ready() const noexcept { return false; }
+
+            bool await_suspend(std::coroutine_handle<> awaiting) {
+                continuation = awaiting;
+                const DagIndexType n = dag.size();
+                indegree.assign(n, 0);
+                for (DagIndexType u = 0; u < n; u++) {
+                    dag.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                        if (passes(edgeFilter, u, to, edge)) indegree[to]++;
+                    });
+                }
+                for (DagIndexType u = n; u-- > 0;) {
+                    if (indegree[u] == 0 && isLive(dag, u)) ready.push_back(u);
+                }
+
+                std::unique_lock<std::mutex> lock(mutex);
+                drive(lock);
+                return latch.fetch_sub(1, std::memory_order_acq_rel) != 1;
+            }
+
+            void await_resume() {
+                if (failure) std::rethrow_exception(failure);
+            }
+
+            decltype(auto) invoke(DagIndexType node) { return fn(node); }
+
+            void complete(DagIndexType node, std::exception_ptr error) {
+                std::unique_lock<std::mutex> lock(mutex);
+                inFlight--;
+                if (error) {
+                    if (!failure) failure = error;
+                }
+                else {
+                    dag.forEachEdge(node, [&](DagIndexType to, const auto& edge) {
+                        if (passes(edgeFilter, node, to, edge) && --indegree[to] == 0) ready.push_back(to);
+                    });
+                }
+                drive(lock);
+            }
+
+        private:
+            const DAG& dag;
+            Fn& fn;
+            Filter& edgeFilter;
+            const size_t limit;
+
+            std::mutex mutex; // guards everything below but `latch`
+            std::vector<DagIndexType> indegree;
+            std::vector<DagIndexType> ready;
+            size_t inFlight = 0;
+            bool driving = false;
+            bool finished = false;
+            std::exception_ptr failure;
+            std::coroutine_handle<> continuation;
+            std::atomic<int> latch{ 2 }; // await_suspend returning + the run finishing
+
+            // Starts ready nodes while the limit allows; after a failure none. Called with the lock
+            // held; nothing may touch *this once the awaiter is resumed.
+            void drive(std::unique_lock<std::mutex>& lock) {
+                if (driving) return;
+                driving = true;
+                while (!failure && !ready.empty() && (limit == 0 || inFlight < limit)) {
+                    const DagIndexType node = ready.back();
+                    ready.pop_back();
+                    inFlight++;
+                    lock.unlock();
+                    runNode(this, node);
+                    lock.lock();
+                }
+                driving = false;
+                const bool done = !finished && inFlight == 0 && (ready.empty() || failure);
+                if (done) finished = true;
+                lock.unlock();
+                if (done && latch.fetch_sub(1, std::memory_order_acq_rel) == 1) continuation.resume();
+            }
+        };
+
+        struct SyncState {
+            std::mutex mutex;
+            std::condition_variable finished;
+            bool done = false;
+            std::exception_ptr error;
+        };
+
+        inline Detached signalWhenDone(Task task, SyncState* state) {
+            try {
+                co_await task;
+            }
+            catch (...) {
+                state->error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->done = true;
+            state->finished.notify_one();
+        }
+    } // namespace detail
+
+    // Runs the coroutine fn(node) once per node after its predecessors, at most `maxInFlight` at a
+    // time (0 = no limit). `dag` must outlive the run and not change during it.
+    template<typename DAG, typename Fn, typename Filter = NoFilter>
+    Task runAsync(const DAG& dag, Fn fn, size_t maxInFlight = 0, Filter edgeFilter = {}) {
+        detail::AsyncRun<DAG, Fn, Filter> run(dag, fn, edgeFilter, maxInFlight);
+        co_await run;
+    }
+
+    // Blocks the calling thread until `task` finished, rethrowing its exception: the bridge from
+    // ordinary code, e.g. syncWait(runAsync(dg, fetch, 64)).
+    inline void syncWait(Task task) {
+        detail::SyncState state;
+        detail::signalWhenDone(std::move(task), &state);
+        std::unique_lock<std::mutex> lock(state.mutex);
+        state.finished.wait(lock, [&] { return state.done; });
+        if (state.error) std::rethrow_exception(state.error);
+    }
+
+} // namespace dag
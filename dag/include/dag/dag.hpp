@@ -1,12 +1,31 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <deque>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <vector>
+#include <memory>
+#include <memory_resource>
 #include <queue>
+#include <span>
 #include <functional>
 #include <string>
+#include <string_view>
 #include <ostream>
+#include <type_traits>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <bit>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 // Hopefully can bring some memory/size optimizations at compile time.
 // USE CASE:
@@ -20,543 +39,3580 @@
 #define DAG_EDGE_FLAGS_TYPE uint32_t
 #endif
 
+// Edges a DynamicDAG node stores inline before its edge list spills to the heap.
+#ifndef DAG_INLINE_EDGES
+#define DAG_INLINE_EDGES 3
+#endif
+
 using DagIndexType = DAG_INDEX_TYPE;
 using DagEdgeFlags = DAG_EDGE_FLAGS_TYPE;
 
 namespace dag
 {
 
-    template<typename T, size_t MaxNodes, size_t MaxEdges>
-    struct StaticDAG {
-        using data_type = T;
+    // Edge description used for batch construction (see addEdges).
+    struct EdgeSpec {
+        DagIndexType from;
+        DagIndexType to;
+        DagEdgeFlags flags = 0;
+    };
 
-        static constexpr DagIndexType npos = -1;
+    // Edge filter meaning "every edge passes". It is the default filter of every traversal and is
+    // recognised at compile time, so unfiltered traversals carry no per-edge call at all.
+    struct NoFilter {};
 
-        struct Node {
-            using data_type = data_type;
-            T data;
-            DagIndexType firstEdge = npos;
-        };
+    // Node index tagged with its slot's generation; it stops resolving once the node is removed.
+    struct NodeHandle {
+        DagIndexType index = static_cast<DagIndexType>(-1);
+        uint32_t generation = 0;
 
-        struct Edge {
-            DagIndexType to;
-            DagIndexType next;
-            DagEdgeFlags flags; // optional metadata
-        };
+        constexpr bool operator==(const NodeHandle&) const = default;
+    };
 
-        std::array<Node, MaxNodes> nodes{};
-        std::array<Edge, MaxEdges> edges{};
-        DagIndexType edgeCount = 0;
-        DagIndexType nodeCount = 0;
-        const char* lastError = nullptr;
+    // Nodes grouped by depth: level i is nodes[offsets[i] .. offsets[i + 1]), with no edge inside a level.
+    struct TopologicalLevels {
+        std::vector<DagIndexType> nodes;
+        std::vector<DagIndexType> offsets{ 0 };
 
-        // === Customizable reachability function ===
-        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, const Edge& edge)>;
+        constexpr DagIndexType levelCount() const { return offsets.size() - 1; }
 
-        void clear() {
-            lastError = nullptr;
-            edgeCount = 0;
-            nodeCount = 0;
+        constexpr std::span<const DagIndexType> level(DagIndexType i) const {
+            return { nodes.data() + offsets[i], nodes.data() + offsets[i + 1] };
         }
+    };
 
-        bool reachable(DagIndexType from, DagIndexType target,
-            ReachableFn edgeFilter = [](DagIndexType, DagIndexType, const Edge&) { return true; }) const
-        {
-            if (from >= nodeCount || target >= nodeCount) return false;
-            std::vector<bool> seen(MaxNodes, false);
-            return dfsReachable(from, target, seen, edgeFilter);
-        }
+    // Node orders reorder() can renumber a graph into; ReverseCuthillMcKee ignores edge directions.
+    enum class Ordering { Topological, BreadthFirst, ReverseCuthillMcKee };
 
-        DagIndexType addNode(const T& data) {
-            if (nodeCount >= MaxNodes) { lastError = "Node pool full"; return npos; }
-            nodes[nodeCount] = { data, npos };
-            return nodeCount++;
-        }
+    // What a stats policy times (see CountingStats).
+    enum class Operation { AddEdge, AddEdges, CycleCheck, RemoveNode, Compact, Reorder, Reachable, TopologicalSort, TopologicalLevels, TransitiveReduction, Count };
 
-        T* addEdge(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
-            if (from >= nodeCount || to >= nodeCount) { lastError = "Invalid node index"; return nullptr; }
-            if (reachable(to, from)) { lastError = "Cycle detected"; return nullptr; }
-            if (edgeCount >= MaxEdges) { lastError = "Edge pool full"; return nullptr; }
+    // Why a mutating call failed; describe() gives the matching lastError string.
+    enum class Rejection { InvalidNode, Cycle, NodePoolFull, EdgePoolFull, EdgeNotFound, StaleHandle, Count };
 
-            edges[edgeCount] = { to, nodes[from].firstEdge, flags };
-            nodes[from].firstEdge = edgeCount++;
-            return &nodes[from].data;
+    constexpr const char* describe(Rejection reason) {
+        switch (reason) {
+        case Rejection::InvalidNode: return "Invalid node index";
+        case Rejection::Cycle: return "Cycle detected";
+        case Rejection::NodePoolFull: return "Node pool full";
+        case Rejection::EdgePoolFull: return "Edge pool full";
+        case Rejection::EdgeNotFound: return "Edge not found";
+        case Rejection::StaleHandle: return "Stale node handle";
+        default: return "Unknown error";
         }
+    }
 
-        std::vector<DagIndexType> topologicalSort(ReachableFn edgeFilter = nullptr) const {
-            std::vector<DagIndexType> indegree(nodeCount, 0);
+    // Default stats policy of StaticDAG and DynamicDAG: empty hooks, no storage, no filter wrapping.
+    struct NoStats {
+        static constexpr bool enabled = false;
 
-            for (DagIndexType i = 0; i < nodeCount; i++) {
-                for (DagIndexType e = nodes[i].firstEdge; e != npos; e = edges[e].next) {
-                    if (!edgeFilter || edgeFilter(i, edges[e].to, edges[e])) {
-                        indegree[edges[e].to]++;
-                    }
-                }
-            }
+        struct Timer {};
 
-            std::queue<DagIndexType> q;
-            for (DagIndexType i = 0; i < nodeCount; i++) if (indegree[i] == 0) q.push(i);
+        constexpr void onNodeVisited() {}
+        constexpr void onEdgeScanned() {}
+        constexpr void onFilterCall() {}
+        constexpr void onAllocation() {}
+        constexpr void onReject(Rejection) {}
+        constexpr Timer time(Operation) { return {}; }
+    };
 
-            std::vector<DagIndexType> order;
-            while (!q.empty()) {
-                auto n = q.front(); q.pop();
-                order.push_back(n);
-                for (DagIndexType e = nodes[n].firstEdge; e != npos; e = edges[e].next) {
-                    auto to = edges[e].to;
-                    if (!edgeFilter || edgeFilter(n, to, edges[e])) {
-                        if (--indegree[to] == 0) q.push(to);
-                    }
-                }
+    // Counts visits, scans, filter calls, allocations, rejections and operations (timed when `timing`
+    // or `onTimed` is set; times are inclusive). Not thread-safe.
+    struct CountingStats {
+        static constexpr bool enabled = true;
+
+        uint64_t nodesVisited = 0;
+        uint64_t edgesScanned = 0;
+        uint64_t filterCalls = 0;
+        uint64_t allocations = 0;
+        std::array<uint64_t, size_t(Rejection::Count)> rejections{};
+        std::array<uint64_t, size_t(Operation::Count)> calls{};
+        std::array<std::chrono::nanoseconds, size_t(Operation::Count)> elapsed{};
+
+        bool timing = false;
+        std::function<void(Operation, std::chrono::nanoseconds)> onTimed;
+
+        uint64_t rejected(Rejection reason) const { return rejections[size_t(reason)]; }
+        uint64_t count(Operation op) const { return calls[size_t(op)]; }
+        std::chrono::nanoseconds timeIn(Operation op) const { return elapsed[size_t(op)]; }
+
+        // Zeroes the counters; `timing` and `onTimed` stay.
+        void reset() {
+            nodesVisited = edgesScanned = filterCalls = allocations = 0;
+            rejections = {};
+            calls = {};
+            elapsed = {};
+        }
+
+        void onNodeVisited() { nodesVisited++; }
+        void onEdgeScanned() { edgesScanned++; }
+        void onFilterCall() { filterCalls++; }
+        void onAllocation() { allocations++; }
+        void onReject(Rejection reason) { rejections[size_t(reason)]++; }
+
+        class Timer {
+        public:
+            Timer(CountingStats* stats, Operation op)
+                : stats(stats), op(op), start(stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+            Timer(const Timer&) = delete;
+            Timer& operator=(const Timer&) = delete;
+
+            ~Timer() {
+                if (!stats) return;
+                const auto spent = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                stats->elapsed[size_t(op)] += spent;
+                if (stats->onTimed) stats->onTimed(op, spent);
             }
 
-            return order;
+        private:
+            CountingStats* stats;
+            Operation op;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        Timer time(Operation op) {
+            calls[size_t(op)]++;
+            return Timer(timing || onTimed ? this : nullptr, op);
         }
+    };
 
-        std::array<std::vector<DagIndexType>, MaxNodes> transitivelyReducePerNode(ReachableFn edgeFilter = nullptr) const {
-            std::array<std::vector<DagIndexType>, MaxNodes> reducedEdges;
-            auto order = topologicalSort(edgeFilter);
-
-            for (auto u : order) {
-                for (DagIndexType e = nodes[u].firstEdge; e != npos; e = edges[e].next) {
-                    auto v = edges[e].to;
-                    // Custom reachability: skip the direct edge (u, v)
-                    std::vector<bool> seen(MaxNodes, false);
-                    bool altPath = false;
-                    for (DagIndexType f = nodes[u].firstEdge; f != npos; f = edges[f].next) {
-                        if (f == e) continue; // skip direct edge
-                        if (dfsReachable(edges[f].to, v, seen, edgeFilter)) {
-                            altPath = true;
-                            break;
-                        }
-                    }
-                    if (!altPath) {
-                        reducedEdges[u].push_back(v);
-                    }
+    namespace detail
+    {
+        enum class WordOp { Or, And, AndNot };
+
+        // dst[w] = dst[w] op src[w] over n words: four at a time with AVX2, two with NEON, and one at a
+        // time for the tail and in constant evaluation.
+        template<WordOp Op>
+        constexpr void combineWords(uint64_t* dst, const uint64_t* src, size_t n) {
+            size_t w = 0;
+            if (!std::is_constant_evaluated()) {
+#if defined(__AVX2__)
+                for (; w + 4 <= n; w += 4) {
+                    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + w));
+                    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + w));
+                    __m256i r;
+                    if constexpr (Op == WordOp::Or) r = _mm256_or_si256(a, b);
+                    else if constexpr (Op == WordOp::And) r = _mm256_and_si256(a, b);
+                    else r = _mm256_andnot_si256(b, a);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + w), r);
                 }
+#elif defined(__ARM_NEON)
+                for (; w + 2 <= n; w += 2) {
+                    const uint64x2_t a = vld1q_u64(dst + w), b = vld1q_u64(src + w);
+                    uint64x2_t r;
+                    if constexpr (Op == WordOp::Or) r = vorrq_u64(a, b);
+                    else if constexpr (Op == WordOp::And) r = vandq_u64(a, b);
+                    else r = vbicq_u64(a, b);
+                    vst1q_u64(dst + w, r);
+                }
+#endif
+            }
+            for (; w < n; w++) {
+                if constexpr (Op == WordOp::Or) dst[w] |= src[w];
+                else if constexpr (Op == WordOp::And) dst[w] &= src[w];
+                else dst[w] &= ~src[w];
             }
-            return reducedEdges;
         }
 
-    private:
-        void dfsMark(DagIndexType node, std::vector<bool>& seen) const {
-            if (seen[node]) return;
-            seen[node] = true;
-            for (DagIndexType e = nodes[node].firstEdge; e != npos; e = edges[e].next) {
-                dfsMark(edges[e].to, seen);
-            }
+        constexpr size_t popcountWords(const uint64_t* words, size_t n) {
+            size_t count = 0;
+            for (size_t w = 0; w < n; w++) count += std::popcount(words[w]);
+            return count;
         }
 
-        bool dfsReachable(DagIndexType current, DagIndexType target, std::vector<bool>& seen, ReachableFn edgeFilter) const {
-            if (current == target) return true;
-            if (seen[current]) return false;
-            seen[current] = true;
+        // Dense rows of bits, one row per node, each `words` 64-bit words wide.
+        struct BitMatrix {
+            std::vector<uint64_t> bits;
+            size_t words = 0;
 
-            for (DagIndexType e = nodes[current].firstEdge; e != npos; e = edges[e].next) {
-                if (edgeFilter(current, edges[e].to, edges[e]) && dfsReachable(edges[e].to, target, seen, edgeFilter))
-                    return true;
+            void assign(DagIndexType rows, DagIndexType columns) {
+                words = (columns + 63) / 64;
+                bits.assign(rows * words, 0);
             }
-            return false;
-        }
-    };
 
-    template<size_t MaxNodes, size_t MaxEdges>
-    struct StaticDAG<void, MaxNodes, MaxEdges> {
-        using data_type = void;
+            uint64_t* row(DagIndexType r) { return bits.data() + r * words; }
+            const uint64_t* row(DagIndexType r) const { return bits.data() + r * words; }
 
-        static constexpr DagIndexType npos = -1;
+            bool test(DagIndexType r, DagIndexType c) const { return (row(r)[c / 64] >> (c % 64)) & 1; }
+            void set(DagIndexType r, DagIndexType c) { row(r)[c / 64] |= uint64_t(1) << (c % 64); }
 
-        struct Node {
-            using data_type = data_type;
-            DagIndexType firstEdge = npos;
-        };
+            void merge(DagIndexType into, DagIndexType from) {
+                combineWords<WordOp::Or>(row(into), row(from), words);
+            }
 
-        struct Edge {
-            DagIndexType to;
-            DagIndexType next;
-            DagEdgeFlags flags; // optional metadata
+            size_t count(DagIndexType r) const { return popcountWords(row(r), words); }
         };
 
-        std::array<Node, MaxNodes> nodes{};
-        std::array<Edge, MaxEdges> edges{};
-        DagIndexType edgeCount = 0;
-        DagIndexType nodeCount = 0;
-        const char* lastError = nullptr;
+        // Flags of the edge argument forEachEdge passes: the flags themselves, a StaticDAG Edge, or 0
+        // for a StaticDAG without flags.
+        template<typename EdgeArg>
+        constexpr DagEdgeFlags edgeFlags(const EdgeArg& edge) {
+            if constexpr (std::is_arithmetic_v<EdgeArg>) return edge;
+            else if constexpr (requires { edge.flags; }) return edge.flags;
+            else return 0;
+        }
+    } // namespace detail
 
-        // === Customizable reachability function ===
-        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, const Edge& edge)>;
+    // Edge filter passing edges with every bit of `all` and, unless `any` is 0, a bit of `any`.
+    struct FlagMask {
+        DagEdgeFlags any = 0;
+        DagEdgeFlags all = 0;
 
-        void clear() {
-            lastError = nullptr;
-            edgeCount = 0;
-            nodeCount = 0;
+        static constexpr FlagMask anyOf(DagEdgeFlags bits) { return { bits, 0 }; }
+        static constexpr FlagMask allOf(DagEdgeFlags bits) { return { 0, bits }; }
+
+        constexpr bool matches(DagEdgeFlags flags) const { return (flags & all) == all && (any == 0 || (flags & any) != 0); }
+
+        template<typename EdgeArg>
+        constexpr bool operator()(DagIndexType, DagIndexType, const EdgeArg& edge) const { return matches(detail::edgeFlags(edge)); }
+
+        constexpr bool operator==(const FlagMask&) const = default;
+    };
+
+    // Set of node indices below size(), one bit per node, with word-at-a-time set operations.
+    class DenseBitset {
+    public:
+        constexpr DenseBitset() = default;
+        constexpr explicit DenseBitset(DagIndexType size) { assign(size); }
+
+        // Resizes to `size` with every bit clear.
+        constexpr void assign(DagIndexType size) {
+            bits = size;
+            words.assign((size + 63) / 64, 0);
         }
 
-        bool reachable(DagIndexType from, DagIndexType target,
-            ReachableFn edgeFilter = [](DagIndexType, DagIndexType, const Edge&) { return true; }) const
-        {
-            if (from >= nodeCount || target >= nodeCount) return false;
-            std::vector<bool> seen(MaxNodes, false);
-            return dfsReachable(from, target, seen, edgeFilter);
+        // Resizes to `size`, keeping the bits below both sizes; new bits are clear.
+        constexpr void resize(DagIndexType size) {
+            if (size < bits && size % 64 != 0) {
+                words[size / 64] &= (uint64_t(1) << (size % 64)) - 1;
+            }
+            bits = size;
+            words.resize((size + 63) / 64, 0);
         }
 
-        DagIndexType addNode() {
-            if (nodeCount >= MaxNodes) { lastError = "Node pool full"; return npos; }
-            nodes[nodeCount] = { npos };
-            return nodeCount++;
+        constexpr void clear() { std::fill(words.begin(), words.end(), 0); }
+
+        constexpr DagIndexType size() const { return bits; }
+
+        constexpr bool test(DagIndexType i) const { return (words[i / 64] >> (i % 64)) & 1; }
+        constexpr void set(DagIndexType i) { words[i / 64] |= uint64_t(1) << (i % 64); }
+        constexpr void reset(DagIndexType i) { words[i / 64] &= ~(uint64_t(1) << (i % 64)); }
+
+        // Sets bit i; false if it was already set.
+        constexpr bool insert(DagIndexType i) {
+            uint64_t& word = words[i / 64];
+            const uint64_t bit = uint64_t(1) << (i % 64);
+            if (word & bit) return false;
+            word |= bit;
+            return true;
         }
 
-        void addEdge(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
-            if (from >= nodeCount || to >= nodeCount) { lastError = "Invalid node index"; return nullptr; }
-            if (reachable(to, from)) { lastError = "Cycle detected"; return nullptr; }
-            if (edgeCount >= MaxEdges) { lastError = "Edge pool full"; return nullptr; }
+        constexpr DagIndexType count() const { return detail::popcountWords(words.data(), words.size()); }
+
+        constexpr bool any() const {
+            for (auto word : words) if (word != 0) return true;
+            return false;
+        }
 
-            edges[edgeCount] = { to, nodes[from].firstEdge, flags };
-            nodes[from].firstEdge = edgeCount++;
+        // Set operations between bitsets of the same size.
+        constexpr DenseBitset& operator|=(const DenseBitset& other) {
+            detail::combineWords<detail::WordOp::Or>(words.data(), other.words.data(), words.size());
+            return *this;
         }
 
-        std::vector<DagIndexType> topologicalSort(ReachableFn edgeFilter = nullptr) const {
-            std::vector<DagIndexType> indegree(nodeCount, 0);
+        constexpr DenseBitset& operator&=(const DenseBitset& other) {
+            detail::combineWords<detail::WordOp::And>(words.data(), other.words.data(), words.size());
+            return *this;
+        }
 
-            for (DagIndexType i = 0; i < nodeCount; i++) {
-                for (DagIndexType e = nodes[i].firstEdge; e != npos; e = edges[e].next) {
-                    if (!edgeFilter || edgeFilter(i, edges[e].to, edges[e])) {
-                        indegree[edges[e].to]++;
-                    }
-                }
-            }
+        // Clears every bit set in `other`.
+        constexpr DenseBitset& operator-=(const DenseBitset& other) {
+            detail::combineWords<detail::WordOp::AndNot>(words.data(), other.words.data(), words.size());
+            return *this;
+        }
 
-            std::queue<DagIndexType> q;
-            for (DagIndexType i = 0; i < nodeCount; i++) if (indegree[i] == 0) q.push(i);
+        constexpr bool operator==(const DenseBitset&) const = default;
 
-            std::vector<DagIndexType> order;
-            while (!q.empty()) {
-                auto n = q.front(); q.pop();
-                order.push_back(n);
-                for (DagIndexType e = nodes[n].firstEdge; e != npos; e = edges[e].next) {
-                    auto to = edges[e].to;
-                    if (!edgeFilter || edgeFilter(n, to, edges[e])) {
-                        if (--indegree[to] == 0) q.push(to);
-                    }
-                }
+        // Calls fn(i) for every set bit, in increasing order.
+        template<typename Fn>
+        constexpr void forEach(Fn&& fn) const {
+            for (size_t w = 0; w < words.size(); w++) {
+                for (uint64_t word = words[w]; word != 0; word &= word - 1) fn(DagIndexType(w * 64 + std::countr_zero(word)));
             }
-
-            return order;
         }
 
-        std::array<std::vector<DagIndexType>, MaxNodes> transitivelyReducePerNode(ReachableFn edgeFilter = nullptr) const {
-            std::array<std::vector<DagIndexType>, MaxNodes> reducedEdges;
-            auto order = topologicalSort(edgeFilter);
-
-            for (auto u : order) {
-                for (DagIndexType e = nodes[u].firstEdge; e != npos; e = edges[e].next) {
-                    auto v = edges[e].to;
-                    // Custom reachability: skip the direct edge (u, v)
-                    std::vector<bool> seen(MaxNodes, false);
-                    bool altPath = false;
-                    for (DagIndexType f = nodes[u].firstEdge; f != npos; f = edges[f].next) {
-                        if (f == e) continue; // skip direct edge
-                        if (dfsReachable(edges[f].to, v, seen, edgeFilter)) {
-                            altPath = true;
-                            break;
-                        }
-                    }
-                    if (!altPath) {
-                        reducedEdges[u].push_back(v);
-                    }
-                }
+        // Calls fn(i) for every clear bit below size(), in increasing order.
+        template<typename Fn>
+        constexpr void forEachClear(Fn&& fn) const {
+            for (size_t w = 0; w < words.size(); w++) {
+                uint64_t word = ~words[w];
+                if (w + 1 == words.size() && bits % 64 != 0) word &= (uint64_t(1) << (bits % 64)) - 1;
+                for (; word != 0; word &= word - 1) fn(DagIndexType(w * 64 + std::countr_zero(word)));
             }
-            return reducedEdges;
         }
 
+        constexpr std::span<const uint64_t> data() const { return words; }
+
     private:
-        void dfsMark(DagIndexType node, std::vector<bool>& seen) const {
-            if (seen[node]) return;
-            seen[node] = true;
-            for (DagIndexType e = nodes[node].firstEdge; e != npos; e = edges[e].next) {
-                dfsMark(edges[e].to, seen);
+        std::vector<uint64_t> words;
+        DagIndexType bits = 0;
+    };
+
+    // Reusable scratch buffers for the query overloads taking one; results returned by reference are
+    // overwritten by the next query. One Workspace per thread.
+    struct Workspace {
+        std::vector<DagIndexType> order;
+        TopologicalLevels levels;
+        DenseBitset reached;
+
+        // Starts a new visited set covering `nodeCount` nodes.
+        void beginVisit(DagIndexType nodeCount) {
+            if (stamps.size() < nodeCount) stamps.resize(nodeCount, 0);
+            epoch += 2;
+            if (epoch >= UINT32_MAX - 1) {
+                std::fill(stamps.begin(), stamps.end(), 0);
+                epoch = 2;
             }
         }
 
-        bool dfsReachable(DagIndexType current, DagIndexType target, std::vector<bool>& seen, ReachableFn edgeFilter) const {
-            if (current == target) return true;
-            if (seen[current]) return false;
-            seen[current] = true;
+        // Marks `node` visited; false if it already was.
+        bool visit(DagIndexType node) {
+            if (stamps[node] == epoch) return false;
+            stamps[node] = epoch;
+            return true;
+        }
 
-            for (DagIndexType e = nodes[current].firstEdge; e != npos; e = edges[e].next) {
-                if (edgeFilter(current, edges[e].to, edges[e]) && dfsReachable(edges[e].to, target, seen, edgeFilter))
-                    return true;
-            }
-            return false;
+        bool visited(DagIndexType node) const { return stamps[node] == epoch; }
+
+        // Two-sided marks for bidirectional searches, sharing the same stamps: side 0 is what visit()
+        // marks, side 1 the other direction. side() is -1 for an unvisited node.
+        void mark(DagIndexType node, int side) { stamps[node] = epoch + side; }
+        int side(DagIndexType node) const {
+            return stamps[node] == epoch ? 0 : stamps[node] == epoch + 1 ? 1 : -1;
         }
+
+        // Scratch shared by the algorithms.
+        std::vector<DagIndexType> stack;
+        std::vector<DagIndexType> frontier;
+        std::vector<DagIndexType> backFrontier;
+        std::vector<DagIndexType> nextFrontier;
+        std::vector<DagIndexType> indegree;
+        std::vector<DagIndexType> rank;
+        std::vector<DagIndexType> successors;
+        std::vector<DagIndexType> byRank;
+        DenseBitset kept;
+        DenseBitset frontierBits;
+        detail::BitMatrix closure;
+
+    private:
+        std::vector<uint32_t> stamps;
+        uint32_t epoch = 0;
     };
 
-    template<typename T>
-    struct DynamicDAG {
-        static constexpr DagIndexType npos = -1;
+    namespace detail
+    {
+        // Evaluates an edge filter of any callable type. NoFilter and nullptr compile away; an empty
+        // std::function or a null function pointer keeps meaning "no filter".
+        template<typename Filter, typename EdgeArg>
+        constexpr bool passes(Filter& filter, DagIndexType from, DagIndexType to, const EdgeArg& edge) {
+            using F = std::remove_cvref_t<Filter>;
+            if constexpr (std::is_same_v<F, NoFilter> || std::is_null_pointer_v<F>) {
+                return true;
+            }
+            else {
+                if constexpr (std::is_constructible_v<bool, Filter&>) {
+                    if (!static_cast<bool>(filter)) return true;
+                }
+                return static_cast<bool>(filter(from, to, edge));
+            }
+        }
 
-        struct Node {
-            T data;
-            std::vector<std::pair<DagIndexType, DagEdgeFlags>> edges; // target + optional flags
+        // Enabled policies are stored mutable (const queries count); disabled ones are not, so constexpr
+        // containers keep working.
+        template<typename Stats, bool = Stats::enabled>
+        struct StatsSlot {
+            mutable Stats value{};
+            Stats& hooks() const { return value; }
         };
 
-        std::vector<Node> nodes;
-        const char* lastError = nullptr;
-
-        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, uint32_t flags)>;
+        template<typename Stats>
+        struct StatsSlot<Stats, false> {
+            [[no_unique_address]] Stats value{};
+            constexpr Stats hooks() const { return {}; }
+        };
 
-        void clear() {
-            lastError = nullptr;
-            nodes.clear();
+        // The filter a container hands its traversals: `filter` itself, or with an enabled stats policy
+        // a wrapper counting each call that reaches the user's filter. NoFilter is never wrapped.
+        template<typename Stats, typename Filter>
+        constexpr decltype(auto) countCalls(Stats&& stats, Filter& filter) {
+            using F = std::remove_cvref_t<Filter>;
+            if constexpr (!std::remove_cvref_t<Stats>::enabled || std::is_same_v<F, NoFilter> || std::is_null_pointer_v<F>) {
+                return (filter);
+            }
+            else {
+                return [&stats, &filter](DagIndexType from, DagIndexType to, const auto& edge) {
+                    if constexpr (std::is_constructible_v<bool, Filter&>) {
+                        if (!static_cast<bool>(filter)) return true;
+                    }
+                    stats.onFilterCall();
+                    return static_cast<bool>(filter(from, to, edge));
+                };
+            }
         }
 
-        DagIndexType addNode(const T& data) {
-            nodes.push_back({ data, {} });
-            return nodes.size() - 1;
+        // Calls fn(args...) and tells an enumeration whether to go on: callbacks returning bool stop it
+        // by returning false, any other callback runs to the end.
+        template<typename Fn, typename... Args>
+        constexpr bool proceed(Fn& fn, Args&&... args) {
+            if constexpr (std::is_same_v<decltype(fn(std::forward<Args>(args)...)), bool>) {
+                return fn(std::forward<Args>(args)...);
+            }
+            else {
+                fn(std::forward<Args>(args)...);
+                return true;
+            }
         }
 
-        bool addEdge(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
-            if (from >= nodes.size() || to >= nodes.size()) { lastError = "Invalid node index"; return false; }
-            if (reachable(to, from)) { lastError = "Cycle detected"; return false; }
-            nodes[from].edges.emplace_back(to, flags);
-            return true;
+        // False for removed node slots, which stay in the index range with no edges. Graphs without
+        // removal (CsrDAG) have no contains() and every index is live.
+        template<typename Graph>
+        constexpr bool isLive(const Graph& g, DagIndexType node) {
+            if constexpr (requires { g.contains(node); }) return g.contains(node);
+            else return true;
         }
 
-        bool reachable(DagIndexType from, DagIndexType target, ReachableFn edgeFilter = nullptr) const {
-            if (from >= nodes.size() || target >= nodes.size()) return false;
-            std::vector<bool> seen(nodes.size(), false);
-            return dfsReachable(from, target, seen, edgeFilter);
+        // Visited sets: a DenseBitset or a Workspace's epoch stamps. Returns false if already seen.
+        constexpr bool visit(DenseBitset& seen, DagIndexType node) { return seen.insert(node); }
+
+        inline bool visit(Workspace& ws, DagIndexType node) { return ws.visit(node); }
+
+        // The algorithms below work on any container exposing size() and forEachEdge(from, fn), where
+        // fn receives (to, edge) and `edge` is what that container's edge filters are given.
+
+        // Explicit-stack DFS from `from`, stopping as soon as `target` is found.
+        template<typename Graph, typename Visited, typename Filter>
+        constexpr bool dfsReachable(const Graph& g, DagIndexType from, DagIndexType target, Visited& seen, std::vector<DagIndexType>& stack, Filter&& edgeFilter) {
+            if (from == target) return true;
+            visit(seen, from);
+            stack.assign(1, from);
+            while (!stack.empty()) {
+                const DagIndexType u = stack.back(); stack.pop_back();
+                bool found = false;
+                g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (found || !passes(edgeFilter, u, to, edge)) return;
+                    if (to == target) found = true;
+                    else if (visit(seen, to)) stack.push_back(to);
+                });
+                if (found) return true;
+            }
+            return false;
         }
 
-        std::vector<DagIndexType> topologicalSort(ReachableFn edgeFilter = nullptr) const {
-            std::vector<DagIndexType> indegree(nodes.size(), 0);
-            for (DagIndexType i = 0; i < nodes.size(); i++) {
-                for (auto& [to, flags] : nodes[i].edges) {
-                    if (!edgeFilter || edgeFilter(i, to, flags)) indegree[to]++;
-                }
-            }
+        template<typename Graph, typename Filter>
+        constexpr bool reachable(const Graph& g, DagIndexType from, DagIndexType target, Filter&& edgeFilter) {
+            if (from >= g.size() || target >= g.size()) return false;
+            DenseBitset seen(g.size());
+            std::vector<DagIndexType> stack;
+            return dfsReachable(g, from, target, seen, stack, edgeFilter);
+        }
 
-            std::queue<DagIndexType> q;
-            for (DagIndexType i = 0; i < nodes.size(); i++) if (indegree[i] == 0) q.push(i);
+        template<typename Graph, typename Filter>
+        bool reachable(const Graph& g, DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter) {
+            if (from >= g.size() || target >= g.size()) return false;
+            ws.beginVisit(g.size());
+            return dfsReachable(g, from, target, ws, ws.stack, edgeFilter);
+        }
 
-            std::vector<DagIndexType> order;
-            while (!q.empty()) {
-                auto n = q.front(); q.pop();
-                order.push_back(n);
-                for (auto& [to, flags] : nodes[n].edges) {
-                    if (!edgeFilter || edgeFilter(n, to, flags)) {
-                        if (--indegree[to] == 0) q.push(to);
+        // Bidirectional BFS for graphs with forEachInEdge: grows the smaller frontier until they meet.
+        template<typename Graph, typename Filter>
+        bool reachableBidirectional(const Graph& g, DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter) {
+            if (from >= g.size() || target >= g.size()) return false;
+            if (from == target) return true;
+
+            ws.beginVisit(g.size());
+            ws.mark(from, 0);
+            ws.mark(target, 1);
+            ws.frontier.assign(1, from);
+            ws.backFrontier.assign(1, target);
+
+            bool met = false;
+            while (!met && !ws.frontier.empty() && !ws.backFrontier.empty()) {
+                ws.nextFrontier.clear();
+                if (ws.frontier.size() <= ws.backFrontier.size()) {
+                    for (auto u : ws.frontier) {
+                        g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                            if (met || !passes(edgeFilter, u, to, edge)) return;
+                            const int side = ws.side(to);
+                            if (side == 1) met = true;
+                            else if (side < 0) { ws.mark(to, 0); ws.nextFrontier.push_back(to); }
+                        });
+                        if (met) break;
                     }
+                    std::swap(ws.frontier, ws.nextFrontier);
+                }
+                else {
+                    for (auto v : ws.backFrontier) {
+                        g.forEachInEdge(v, [&](DagIndexType source, const auto& edge) {
+                            if (met || !passes(edgeFilter, source, v, edge)) return;
+                            const int side = ws.side(source);
+                            if (side == 0) met = true;
+                            else if (side < 0) { ws.mark(source, 1); ws.nextFrontier.push_back(source); }
+                        });
+                        if (met) break;
+                    }
+                    std::swap(ws.backFrontier, ws.nextFrontier);
                 }
             }
-
-            return order;
+            return met;
         }
 
-        std::vector<std::vector<DagIndexType>> transitivelyReducePerNode(ReachableFn edgeFilter = nullptr) const {
-            std::vector<std::vector<DagIndexType>> reducedEdges(nodes.size());
+        template<typename Graph>
+        inline constexpr bool hasInEdgeApi = requires(const Graph& g) { g.predecessorsEnabled(); } || requires(const Graph& g) { g.hasPredecessors(); };
 
-            auto order = topologicalSort(edgeFilter);
-            for (auto u : order) {
-                for (size_t i = 0; i < nodes[u].edges.size(); ++i) {
-                    auto v = nodes[u].edges[i].first;
-                    // Custom reachability: skip the direct edge (u, v)
-                    std::vector<bool> seen(nodes.size(), false);
-                    bool altPath = false;
-                    for (size_t j = 0; j < nodes[u].edges.size(); ++j) {
-                        if (i == j) continue; // skip direct edge
-                        if (dfsReachable(nodes[u].edges[j].first, v, seen, edgeFilter)) {
-                            altPath = true;
-                            break;
-                        }
+        // True if forEachInEdge can be used on `g` right now.
+        template<typename Graph>
+        constexpr bool hasInEdges(const Graph& g) {
+            if constexpr (requires { g.predecessorsEnabled(); }) return g.predecessorsEnabled();
+            else if constexpr (requires { g.hasPredecessors(); }) return g.hasPredecessors();
+            else return false;
+        }
+
+        // A frontier larger than 1 / pullFactor of the unreached nodes is expanded bottom-up.
+        inline constexpr DagIndexType pullFactor = 2;
+
+        // Direction-optimizing BFS (Beamer et al.) marking in ws.reached everything reachable from
+        // `sources`; wide levels pull through in-edges when the graph has predecessor lists.
+        template<typename Graph, typename Filter>
+        void reachableSet(const Graph& g, std::span<const DagIndexType> sources, Workspace& ws, Filter&& edgeFilter) {
+            const DagIndexType n = g.size();
+            ws.reached.assign(n);
+            ws.frontier.clear();
+            for (auto source : sources) {
+                if (source < n && isLive(g, source) && ws.reached.insert(source)) ws.frontier.push_back(source);
+            }
+            DagIndexType unreached = n - ws.frontier.size();
+
+            [[maybe_unused]] const bool canPull = hasInEdges(g);
+            while (!ws.frontier.empty()) {
+                ws.nextFrontier.clear();
+                bool pulled = false;
+                if constexpr (hasInEdgeApi<Graph>) {
+                    if (canPull && ws.frontier.size() * pullFactor > unreached) {
+                        ws.frontierBits.assign(n);
+                        for (auto u : ws.frontier) ws.frontierBits.set(u);
+                        ws.reached.forEachClear([&](DagIndexType v) {
+                            bool found = false;
+                            g.forEachInEdge(v, [&](DagIndexType from, const auto& edge) {
+                                found = ws.frontierBits.test(from) && passes(edgeFilter, from, v, edge);
+                                return !found;
+                            });
+                            if (found) ws.nextFrontier.push_back(v);
+                        });
+                        for (auto v : ws.nextFrontier) ws.reached.set(v);
+                        pulled = true;
                     }
-                    if (!altPath) {
-                        reducedEdges[u].push_back(v);
+                }
+                if (!pulled) {
+                    for (auto u : ws.frontier) {
+                        g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                            if (passes(edgeFilter, u, to, edge) && ws.reached.insert(to)) ws.nextFrontier.push_back(to);
+                        });
                     }
                 }
+                unreached -= ws.nextFrontier.size();
+                std::swap(ws.frontier, ws.nextFrontier);
             }
-            return reducedEdges;
         }
 
-    private:
-        void dfsMark(DagIndexType current, std::vector<bool>& seen) const {
-            if (seen[current]) return;
-            seen[current] = true;
-            for (auto& [to, _] : nodes[current].edges) {
-                dfsMark(to, seen);
+        // Kahn's algorithm into `order`, which doubles as the FIFO queue.
+        template<typename Graph, typename Filter>
+        constexpr void topologicalSort(const Graph& g, Filter&& edgeFilter, std::vector<DagIndexType>& indegree, std::vector<DagIndexType>& order) {
+            const DagIndexType n = g.size();
+            indegree.assign(n, 0);
+            for (DagIndexType i = 0; i < n; i++) {
+                g.forEachEdge(i, [&](DagIndexType to, const auto& edge) {
+                    if (passes(edgeFilter, i, to, edge)) indegree[to]++;
+                });
             }
-        }
 
-        bool dfsReachable(DagIndexType current, DagIndexType target, std::vector<bool>& seen, ReachableFn edgeFilter) const {
-            if (current == target) return true;
-            if (seen[current]) return false;
-            seen[current] = true;
+            order.clear();
+            order.reserve(n);
+            for (DagIndexType i = 0; i < n; i++) if (indegree[i] == 0 && isLive(g, i)) order.push_back(i);
 
-            for (auto& [to, flags] : nodes[current].edges) {
-                if (!edgeFilter || edgeFilter(current, to, flags)) {
-                    if (dfsReachable(to, target, seen, edgeFilter)) return true;
-                }
+            for (DagIndexType head = 0; head < order.size(); head++) {
+                const DagIndexType u = order[head];
+                g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (passes(edgeFilter, u, to, edge)) {
+                        if (--indegree[to] == 0) order.push_back(to);
+                    }
+                });
             }
-            return false;
         }
-    };
-
-    template<>
-    struct DynamicDAG<void> {
-        static constexpr DagIndexType npos = -1;
-
-        struct Node {
-            std::vector<std::pair<DagIndexType, DagEdgeFlags>> edges; // target + optional flags
-        };
 
-        std::vector<Node> nodes;
-        const char* lastError = nullptr;
-
-        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, uint32_t flags)>;
-
-        void clear() {
-            lastError = nullptr;
-            nodes.clear();
+        template<typename Graph, typename Filter>
+        constexpr std::vector<DagIndexType> topologicalSort(const Graph& g, Filter&& edgeFilter) {
+            std::vector<DagIndexType> indegree, order;
+            topologicalSort(g, edgeFilter, indegree, order);
+            return order;
         }
 
-        DagIndexType addNode() {
-            nodes.push_back({ {} });
-            return nodes.size() - 1;
-        }
+        // Explicit-stack DFS marking in ws.reached everything reachable from `sources`, calling fn on
+        // each new node; returns false if fn stopped it.
+        template<typename Graph, typename Fn, typename Filter>
+        bool markDescendants(const Graph& g, std::span<const DagIndexType> sources, Workspace& ws, Fn& fn, Filter& edgeFilter) {
+            const DagIndexType n = g.size();
+            ws.reached.assign(n);
+            ws.stack.clear();
+            for (auto source : sources) {
+                if (source >= n || !isLive(g, source) || !ws.reached.insert(source)) continue;
+                if (!proceed(fn, source)) return false;
+                ws.stack.push_back(source);
+            }
 
-        bool addEdge(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
-            if (from >= nodes.size() || to >= nodes.size()) { lastError = "Invalid node index"; return false; }
-            if (reachable(to, from)) { lastError = "Cycle detected"; return false; }
-            nodes[from].edges.emplace_back(to, flags);
-            return true;
+            bool stopped = false;
+            while (!ws.stack.empty() && !stopped) {
+                const DagIndexType u = ws.stack.back(); ws.stack.pop_back();
+                g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (stopped || !passes(edgeFilter, u, to, edge) || !ws.reached.insert(to)) return;
+                    if (proceed(fn, to)) ws.stack.push_back(to);
+                    else stopped = true;
+                });
+            }
+            return !stopped;
         }
 
-        bool reachable(DagIndexType from, DagIndexType target, ReachableFn edgeFilter = nullptr) const {
-            if (from >= nodes.size() || target >= nodes.size()) return false;
-            std::vector<bool> seen(nodes.size(), false);
-            return dfsReachable(from, target, seen, edgeFilter);
-        }
+        // The same backwards, over predecessor lists or else a reverse topological order.
+        template<typename Graph, typename Fn, typename Filter>
+        bool markAncestors(const Graph& g, std::span<const DagIndexType> targets, Workspace& ws, Fn& fn, Filter& edgeFilter) {
+            const DagIndexType n = g.size();
+            if constexpr (hasInEdgeApi<Graph>) {
+                if (hasInEdges(g)) {
+                    ws.reached.assign(n);
+                    ws.stack.clear();
+                    for (auto target : targets) {
+                        if (target >= n || !isLive(g, target) || !ws.reached.insert(target)) continue;
+                        if (!proceed(fn, target)) return false;
+                        ws.stack.push_back(target);
+                    }
 
-        std::vector<DagIndexType> topologicalSort(ReachableFn edgeFilter = nullptr) const {
-            std::vector<DagIndexType> indegree(nodes.size(), 0);
-            for (DagIndexType i = 0; i < nodes.size(); i++) {
-                for (auto& [to, flags] : nodes[i].edges) {
-                    if (!edgeFilter || edgeFilter(i, to, flags)) indegree[to]++;
+                    bool stopped = false;
+                    while (!ws.stack.empty() && !stopped) {
+                        const DagIndexType v = ws.stack.back(); ws.stack.pop_back();
+                        g.forEachInEdge(v, [&](DagIndexType from, const auto& edge) {
+                            if (!passes(edgeFilter, from, v, edge) || !ws.reached.insert(from)) return true;
+                            if (proceed(fn, from)) ws.stack.push_back(from);
+                            else stopped = true;
+                            return !stopped;
+                        });
+                    }
+                    return !stopped;
+                }
+            }
+
+            topologicalSort(g, edgeFilter, ws.indegree, ws.order);
+            ws.reached.assign(n);
+            for (auto target : targets) {
+                if (target >= n || !isLive(g, target) || !ws.reached.insert(target)) continue;
+                if (!proceed(fn, target)) return false;
+            }
+            for (auto it = ws.order.rbegin(); it != ws.order.rend(); ++it) {
+                const DagIndexType u = *it;
+                if (ws.reached.test(u)) continue;
+                bool ancestor = false;
+                g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (!ancestor && ws.reached.test(to) && passes(edgeFilter, u, to, edge)) ancestor = true;
+                });
+                if (ancestor) {
+                    ws.reached.set(u);
+                    if (!proceed(fn, u)) return false;
                 }
             }
+            return true;
+        }
 
-            std::queue<DagIndexType> q;
-            for (DagIndexType i = 0; i < nodes.size(); i++) if (indegree[i] == 0) q.push(i);
+        // The live nodes of `g` in `policy` order: element i is the node that becomes index i.
+        template<typename Graph>
+        constexpr std::vector<DagIndexType> ordering(const Graph& g, Ordering policy) {
+            const DagIndexType n = g.size();
+            if (policy == Ordering::Topological) return topologicalSort(g, NoFilter{});
 
             std::vector<DagIndexType> order;
-            while (!q.empty()) {
-                auto n = q.front(); q.pop();
-                order.push_back(n);
-                for (auto& [to, flags] : nodes[n].edges) {
-                    if (!edgeFilter || edgeFilter(n, to, flags)) {
-                        if (--indegree[to] == 0) q.push(to);
+            order.reserve(n);
+            DenseBitset placed(n);
+            if (policy == Ordering::BreadthFirst) {
+                std::vector<DagIndexType> indegree(n, 0);
+                for (DagIndexType u = 0; u < n; u++) g.forEachEdge(u, [&](DagIndexType to, const auto&) { indegree[to]++; });
+                for (DagIndexType root = 0; root < n; root++) {
+                    if (indegree[root] != 0 || !isLive(g, root) || !placed.insert(root)) continue;
+                    order.push_back(root);
+                    for (DagIndexType head = order.size() - 1; head < order.size(); head++) {
+                        const DagIndexType u = order[head];
+                        g.forEachEdge(u, [&](DagIndexType to, const auto&) {
+                            if (placed.insert(to)) order.push_back(to);
+                        });
                     }
                 }
+                return order;
             }
 
+            // Undirected neighbour lists in CSR form.
+            std::vector<DagIndexType> offsets(n + 1, 0), neighbours;
+            for (DagIndexType u = 0; u < n; u++) {
+                g.forEachEdge(u, [&](DagIndexType to, const auto&) { offsets[u + 1]++; offsets[to + 1]++; });
+            }
+            for (DagIndexType i = 0; i < n; i++) offsets[i + 1] += offsets[i];
+            neighbours.resize(offsets[n]);
+            std::vector<DagIndexType> cursor(offsets.begin(), offsets.end() - 1);
+            for (DagIndexType u = 0; u < n; u++) {
+                g.forEachEdge(u, [&](DagIndexType to, const auto&) {
+                    neighbours[cursor[u]++] = to;
+                    neighbours[cursor[to]++] = u;
+                });
+            }
+            auto degree = [&](DagIndexType u) { return offsets[u + 1] - offsets[u]; };
+            auto byDegree = [&](DagIndexType a, DagIndexType b) { return degree(a) != degree(b) ? degree(a) < degree(b) : a < b; };
+
+            // Cuthill-McKee from a lowest-degree node of each component, then reversed.
+            std::vector<DagIndexType> starts;
+            for (DagIndexType u = 0; u < n; u++) if (isLive(g, u)) starts.push_back(u);
+            std::sort(starts.begin(), starts.end(), byDegree);
+            for (auto start : starts) {
+                if (!placed.insert(start)) continue;
+                order.push_back(start);
+                for (DagIndexType head = order.size() - 1; head < order.size(); head++) {
+                    const DagIndexType u = order[head];
+                    const DagIndexType first = order.size();
+                    for (DagIndexType k = offsets[u]; k < offsets[u + 1]; k++) {
+                        if (placed.insert(neighbours[k])) order.push_back(neighbours[k]);
+                    }
+                    std::sort(order.begin() + first, order.end(), byDegree);
+                }
+            }
+            std::reverse(order.begin(), order.end());
             return order;
         }
 
-        std::vector<std::vector<DagIndexType>> transitivelyReducePerNode(ReachableFn edgeFilter = nullptr) const {
-            std::vector<std::vector<DagIndexType>> reducedEdges(nodes.size());
+        // Kahn's algorithm one frontier at a time; the output buffer doubles as the queue.
+        template<typename Graph, typename Filter>
+        constexpr void topologicalLevels(const Graph& g, Filter&& edgeFilter, std::vector<DagIndexType>& indegree, TopologicalLevels& levels) {
+            const DagIndexType n = g.size();
+            indegree.assign(n, 0);
+            for (DagIndexType i = 0; i < n; i++) {
+                g.forEachEdge(i, [&](DagIndexType to, const auto& edge) {
+                    if (passes(edgeFilter, i, to, edge)) indegree[to]++;
+                });
+            }
 
-            auto order = topologicalSort(edgeFilter);
-            for (auto u : order) {
-                for (size_t i = 0; i < nodes[u].edges.size(); ++i) {
-                    auto v = nodes[u].edges[i].first;
-                    // Custom reachability: skip the direct edge (u, v)
-                    std::vector<bool> seen(nodes.size(), false);
-                    bool altPath = false;
-                    for (size_t j = 0; j < nodes[u].edges.size(); ++j) {
-                        if (i == j) continue; // skip direct edge
-                        if (dfsReachable(nodes[u].edges[j].first, v, seen, edgeFilter)) {
-                            altPath = true;
-                            break;
+            levels.nodes.clear();
+            levels.nodes.reserve(n);
+            levels.offsets.assign(1, 0);
+            for (DagIndexType i = 0; i < n; i++) if (indegree[i] == 0 && isLive(g, i)) levels.nodes.push_back(i);
+
+            DagIndexType begin = 0;
+            while (begin < levels.nodes.size()) {
+                const DagIndexType end = levels.nodes.size();
+                for (DagIndexType k = begin; k < end; k++) {
+                    const DagIndexType u = levels.nodes[k];
+                    g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                        if (passes(edgeFilter, u, to, edge)) {
+                            if (--indegree[to] == 0) levels.nodes.push_back(to);
                         }
-                    }
-                    if (!altPath) {
-                        reducedEdges[u].push_back(v);
-                    }
+                    });
                 }
+                levels.offsets.push_back(end);
+                begin = end;
             }
-            return reducedEdges;
         }
 
-    private:
-        void dfsMark(DagIndexType current, std::vector<bool>& seen) const {
-            if (seen[current]) return;
-            seen[current] = true;
-            for (auto& [to, _] : nodes[current].edges) {
-                dfsMark(to, seen);
-            }
+        template<typename Graph, typename Filter>
+        constexpr TopologicalLevels topologicalLevels(const Graph& g, Filter&& edgeFilter) {
+            std::vector<DagIndexType> indegree;
+            TopologicalLevels levels;
+            topologicalLevels(g, edgeFilter, indegree, levels);
+            return levels;
         }
 
-        bool dfsReachable(DagIndexType current, DagIndexType target, std::vector<bool>& seen, ReachableFn edgeFilter) const {
-            if (current == target) return true;
-            if (seen[current]) return false;
-            seen[current] = true;
+        // Transitive reduction of the edges passing `edgeFilter`, O(V + E * V / 64) with a closure
+        // bitset per node. Kept successors are appended, in edge order, to the empty reducedEdges[u].
+        template<typename Graph, typename Filter, typename Out>
+        void transitivelyReduce(const Graph& g, Out& reducedEdges, Workspace& ws, Filter&& edgeFilter) {
+            const DagIndexType n = g.size();
+            topologicalSort(g, edgeFilter, ws.indegree, ws.order);
+            ws.rank.assign(n, 0);
+            for (DagIndexType i = 0; i < ws.order.size(); i++) ws.rank[ws.order[i]] = i;
+
+            ws.closure.assign(n, n);
+            ws.kept.assign(n);
+
+            for (auto it = ws.order.rbegin(); it != ws.order.rend(); ++it) {
+                const DagIndexType u = *it;
+                ws.successors.clear();
+                g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (passes(edgeFilter, u, to, edge)) ws.successors.push_back(to);
+                });
+
+                ws.byRank.assign(ws.successors.begin(), ws.successors.end());
+                std::sort(ws.byRank.begin(), ws.byRank.end(), [&](DagIndexType a, DagIndexType b) { return ws.rank[a] < ws.rank[b]; });
+                for (auto v : ws.byRank) {
+                    if (ws.closure.test(u, v)) continue; // reachable through an earlier kept successor
+                    ws.kept.set(v);
+                    ws.closure.merge(u, v);
+                }
+                ws.closure.set(u, u);
 
-            for (auto& [to, flags] : nodes[current].edges) {
-                if (!edgeFilter || edgeFilter(current, to, flags)) {
-                    if (dfsReachable(to, target, seen, edgeFilter)) return true;
+                for (auto v : ws.successors) {
+                    if (!ws.kept.test(v)) continue;
+                    ws.kept.reset(v);
+                    reducedEdges[u].push_back(v);
                 }
             }
-            return false;
         }
-    };
 
-    template<typename DAG>
-    void exportToDot(
-        const DAG& dag,
-        std::ostream& output,
-        std::function<std::string(DagIndexType)> nodeLabel = nullptr,
-        std::function<bool(DagIndexType, DagIndexType)> edgeFilter = nullptr
-    ) {
-        output << "digraph DAG {\n";
+        template<typename Graph, typename Filter, typename Out>
+        void transitivelyReduce(const Graph& g, Out& reducedEdges, Filter&& edgeFilter) {
+            Workspace ws;
+            transitivelyReduce(g, reducedEdges, ws, edgeFilter);
+        }
+
+        template<typename Allocator, typename T>
+        using rebind_alloc_t = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+        // Allocator-aware vector keeping its first N elements inline; DynamicDAG edge lists use it.
+        template<typename T, size_t N, typename Allocator>
+        class SmallVector {
+            static_assert(N > 0, "use std::vector for no inline storage");
+            using Traits = std::allocator_traits<Allocator>;
+
+        public:
+            using value_type = T;
+            using allocator_type = Allocator;
+            using iterator = T*;
+            using const_iterator = const T*;
+            using reverse_iterator = std::reverse_iterator<iterator>;
+            using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+            SmallVector() = default;
+            explicit SmallVector(const Allocator& allocator) : allocator(allocator) {}
+
+            SmallVector(const SmallVector& other)
+                : allocator(Traits::select_on_container_copy_construction(other.allocator)) {
+                construct(other.begin(), other.end());
+            }
+
+            SmallVector(const SmallVector& other, const Allocator& allocator) : allocator(allocator) {
+                construct(other.begin(), other.end());
+            }
+
+            SmallVector(SmallVector&& other) noexcept : allocator(std::move(other.allocator)) { take(other); }
+
+            SmallVector(SmallVector&& other, const Allocator& allocator) : allocator(allocator) {
+                if (this->allocator == other.allocator) take(other);
+                else construct(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            }
 
-        // Default node label function
-        if (!nodeLabel) {
-            nodeLabel = [&](DagIndexType i) {
-                // Attempt to access `data` for label
-                if constexpr (requires { dag.nodes[i].data; }) {
-                    return std::to_string(dag.nodes[i].data);
+            SmallVector& operator=(const SmallVector& other) {
+                if (this != &other) {
+                    clear();
+                    construct(other.begin(), other.end());
+                }
+                return *this;
+            }
+
+            SmallVector& operator=(SmallVector&& other) noexcept(Traits::propagate_on_container_move_assignment::value || Traits::is_always_equal::value) {
+                if (this == &other) return *this;
+                clear();
+                if (Traits::propagate_on_container_move_assignment::value || allocator == other.allocator) {
+                    deallocate();
+                    if constexpr (Traits::propagate_on_container_move_assignment::value) allocator = std::move(other.allocator);
+                    take(other);
                 }
                 else {
-                    return std::to_string(i);
+                    construct(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                    other.clear();
                 }
-                };
-        }
+                return *this;
+            }
 
-        // Iterate nodes and edges
-        if constexpr (requires { typename DAG::Node; DAG::npos; }) {
-            // StaticDAG
-            for (size_t i = 0; i < dag.nodeCount; ++i) {
-                for (DagIndexType e = dag.nodes[i].firstEdge; e != DAG::npos; e = dag.edges[e].next) {
-                    auto to = dag.edges[e].to;
-                    if (!edgeFilter || edgeFilter(i, to)) {
-                        output << "    " << nodeLabel(i) << " -> " << nodeLabel(to) << ";\n";
-                    }
+            ~SmallVector() {
+                clear();
+                deallocate();
+            }
+
+            allocator_type get_allocator() const { return allocator; }
+
+            T* data() { return onHeap() ? heap : inlineData(); }
+            const T* data() const { return onHeap() ? heap : inlineData(); }
+
+            iterator begin() { return data(); }
+            iterator end() { return data() + count; }
+            const_iterator begin() const { return data(); }
+            const_iterator end() const { return data() + count; }
+            reverse_iterator rbegin() { return reverse_iterator(end()); }
+            reverse_iterator rend() { return reverse_iterator(begin()); }
+            const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+            const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+            size_t size() const { return count; }
+            size_t capacity() const { return room; }
+            bool empty() const { return count == 0; }
+
+            T& operator[](size_t i) { return data()[i]; }
+            const T& operator[](size_t i) const { return data()[i]; }
+
+            void reserve(size_t capacity) {
+                if (capacity <= room) return;
+                T* grown = Traits::allocate(allocator, capacity);
+                T* from = data();
+                for (uint32_t i = 0; i < count; i++) {
+                    Traits::construct(allocator, grown + i, std::move(from[i]));
+                    Traits::destroy(allocator, from + i);
                 }
+                deallocate();
+                heap = grown;
+                room = static_cast<uint32_t>(capacity);
             }
-        }
-        else {
-            // DynamicDAG
-            for (size_t i = 0; i < dag.nodes.size(); ++i) {
-                for (auto& [to, _] : dag.nodes[i].edges) {
-                    if (!edgeFilter || edgeFilter(i, to)) {
-                        output << "    " << nodeLabel(i) << " -> " << nodeLabel(to) << ";\n";
+
+            template<typename... Args>
+            T& emplace_back(Args&&... args) {
+                if (count == room) reserve(size_t(room) * 2);
+                T* slot = data() + count;
+                Traits::construct(allocator, slot, std::forward<Args>(args)...);
+                count++;
+                return *slot;
+            }
+
+            void pop_back() { Traits::destroy(allocator, data() + --count); }
+
+            iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+            iterator erase(const_iterator first, const_iterator last) {
+                T* items = data();
+                T* gap = items + (first - items);
+                T* kept = std::move(items + (last - items), end(), gap);
+                for (T* p = kept; p != end(); ++p) Traits::destroy(allocator, p);
+                count = static_cast<uint32_t>(kept - items);
+                return gap;
+            }
+
+            // Counterpart of std::erase_if for std::vector, found by argument-dependent lookup.
+            template<typename Pred>
+            friend size_t erase_if(SmallVector& v, Pred pred) {
+                const size_t before = v.size();
+                v.erase(std::remove_if(v.begin(), v.end(), pred), v.end());
+                return before - v.size();
+            }
+
+            void clear() {
+                T* items = data();
+                for (uint32_t i = 0; i < count; i++) Traits::destroy(allocator, items + i);
+                count = 0;
+            }
+
+        private:
+            [[no_unique_address]] Allocator allocator{};
+            uint32_t count = 0;
+            uint32_t room = N; // above N the elements are on the heap
+            union {
+                alignas(T) unsigned char buffer[N * sizeof(T)];
+                T* heap;
+            };
+
+            bool onHeap() const { return room > N; }
+            T* inlineData() { return std::launder(reinterpret_cast<T*>(buffer)); }
+            const T* inlineData() const { return std::launder(reinterpret_cast<const T*>(buffer)); }
+
+            void deallocate() {
+                if (!onHeap()) return;
+                Traits::deallocate(allocator, heap, room);
+                room = N;
+            }
+
+            // Appends [first, last) to an empty vector.
+            template<typename It>
+            void construct(It first, It last) {
+                reserve(static_cast<size_t>(std::distance(first, last)));
+                for (T* slot = data(); first != last; ++first, ++slot, ++count) Traits::construct(allocator, slot, *first);
+            }
+
+            // Takes over the elements of `other`, which is left empty; this one must be empty and inline.
+            void take(SmallVector& other) noexcept {
+                if (other.onHeap()) {
+                    heap = other.heap;
+                    room = other.room;
+                    other.room = N;
+                }
+                else {
+                    T* from = other.inlineData();
+                    for (uint32_t i = 0; i < other.count; i++) {
+                        Traits::construct(allocator, inlineData() + i, std::move(from[i]));
+                        Traits::destroy(other.allocator, from + i);
                     }
                 }
+                count = other.count;
+                other.count = 0;
             }
-        }
+        };
 
-        output << "}\n";
-    }
+        // Narrowest unsigned type holding every index below `Count` plus an end-of-list sentinel.
+        template<size_t Count>
+        using smallest_index_t =
+            std::conditional_t<(Count < UINT8_MAX), uint8_t,
+            std::conditional_t<(Count < UINT16_MAX), uint16_t,
+            std::conditional_t<(Count < UINT32_MAX), uint32_t, uint64_t>>>;
+
+        // StaticDAG edge record; Flags = void drops the flags field altogether.
+        template<typename Index, typename Flags>
+        struct StaticEdge {
+            Index to;
+            Index next;
+            Flags flags; // optional metadata
+        };
 
+        template<typename Index>
+        struct StaticEdge<Index, void> {
+            Index to;
+            Index next;
+        };
 
+        // Live topological order kept across edge insertions (Marchetti-Spaccamela et al.): `rank` maps
+        // node -> position, `order` position -> node.
+        struct IncrementalOrder {
+            std::vector<DagIndexType> rank;
+            std::vector<DagIndexType> order;
+            bool enabled = false;
+
+            // `topo` leaves out removed slots; they are ranked after it so that a recycled slot
+            // already has a position.
+            constexpr void reset(std::vector<DagIndexType> topo, DagIndexType nodeCount) {
+                enabled = true;
+                order = std::move(topo);
+                visited.assign(nodeCount);
+                for (auto n : order) visited.set(n);
+                for (DagIndexType n = 0; n < nodeCount; n++) if (!visited.test(n)) order.push_back(n);
+                visited.assign(nodeCount);
+                rank.assign(nodeCount, 0);
+                for (DagIndexType i = 0; i < order.size(); i++) rank[order[i]] = i;
+            }
+
+            constexpr void clear() {
+                rank.clear();
+                order.clear();
+                visited = {};
+            }
+
+            constexpr void push(DagIndexType node) {
+                rank.push_back(order.size());
+                order.push_back(node);
+                visited.resize(visited.size() + 1);
+            }
+
+            // Returns false if the edge from -> to would close a cycle in `g`, leaving the order untouched.
+            template<typename Graph>
+            constexpr bool insert(const Graph& g, DagIndexType from, DagIndexType to) {
+                if (from == to) return false;
+                const DagIndexType lower = rank[to], upper = rank[from];
+                if (upper < lower) return true;
+
+                // Forward search from `to`, bounded to the affected region (ranks up to `from`).
+                region.clear();
+                stack.clear();
+                stack.push_back(to);
+                visited.set(to);
+                bool cycle = false;
+                while (!stack.empty() && !cycle) {
+                    auto n = stack.back(); stack.pop_back();
+                    region.push_back(n);
+                    g.forEachEdge(n, [&](DagIndexType succ, const auto&) {
+                        if (succ == from) cycle = true;
+                        if (!visited.test(succ) && rank[succ] <= upper) {
+                            visited.set(succ);
+                            stack.push_back(succ);
+                        }
+                    });
+                }
+
+                if (cycle) {
+                    for (auto n : region) visited.reset(n);
+                    for (auto n : stack) visited.reset(n);
+                    return false;
+                }
+
+                // Untouched nodes keep their relative order and go first, those reachable from `to` follow.
+                std::sort(region.begin(), region.end(), [&](DagIndexType a, DagIndexType b) { return rank[a] < rank[b]; });
+                for (DagIndexType p = lower; p <= upper; p++) {
+                    if (!visited.test(order[p])) stack.push_back(order[p]);
+                }
+                DagIndexType p = lower;
+                for (auto n : stack) { order[p] = n; rank[n] = p; p++; }
+                for (auto n : region) { order[p] = n; rank[n] = p; p++; visited.reset(n); }
+                return true;
+            }
+
+        private:
+            std::vector<DagIndexType> stack;
+            std::vector<DagIndexType> region;
+            DenseBitset visited;
+        };
+
+        // One cycle among the nodes a Kahn order that stopped short left behind, v0 -> ... -> vk -> v0.
+        template<typename Graph>
+        constexpr std::vector<DagIndexType> findCycle(const Graph& g, const std::vector<DagIndexType>& order) {
+            constexpr DagIndexType none = static_cast<DagIndexType>(-1);
+            const DagIndexType nodeCount = g.size();
+            DenseBitset sorted(nodeCount);
+            for (auto n : order) sorted.set(n);
+            for (DagIndexType u = 0; u < nodeCount; u++) if (!isLive(g, u)) sorted.set(u);
+
+            std::vector<DagIndexType> pred(nodeCount, none);
+            DagIndexType start = none;
+            for (DagIndexType u = 0; u < nodeCount; u++) {
+                if (sorted.test(u)) continue;
+                if (start == none) start = u;
+                g.forEachEdge(u, [&](DagIndexType to, const auto&) { if (!sorted.test(to)) pred[to] = u; });
+            }
+
+            std::vector<DagIndexType> cycle;
+            if (start == none) return cycle;
+
+            // Walk back until a node repeats; that node lies on a cycle.
+            DenseBitset onPath(nodeCount);
+            DagIndexType n = start;
+            while (onPath.insert(n)) n = pred[n];
+
+            DagIndexType c = n;
+            do { cycle.push_back(c); c = pred[c]; } while (c != n);
+            std::reverse(cycle.begin(), cycle.end());
+            return cycle;
+        }
+
+        // Node slot of a StaticDAG: non-trivial payloads sit in a union and exist only while the slot is
+        // live; trivial ones stay plain members for constexpr use.
+        template<typename T, typename Index, bool = std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>>
+        struct StaticNode {
+            using data_type = T;
+            T data;
+            Index firstEdge = static_cast<Index>(-1);
+        };
+
+        template<typename T, typename Index>
+        struct StaticNode<T, Index, false> {
+            using data_type = T;
+            union { T data; };
+            Index firstEdge = static_cast<Index>(-1);
+
+            constexpr StaticNode() {}
+            constexpr ~StaticNode() {}
+        };
+
+        // Node pool of a StaticDAG; copies, moves and destruction touch only the live payloads.
+        template<typename Node, size_t MaxNodes>
+        struct StaticNodePool {
+            std::array<Node, MaxNodes> nodes{};
+            std::array<uint32_t, MaxNodes> generations{}; // 0 marks a free slot
+            DagIndexType nodeCount = 0; // node slots handed out, removed ones included (see size())
+
+            constexpr StaticNodePool() = default;
+            // Delegating, so payloads already copied are destroyed if a later copy throws.
+            constexpr StaticNodePool(const StaticNodePool& other) : StaticNodePool() { take(other); }
+            constexpr StaticNodePool(StaticNodePool&& other) noexcept(std::is_nothrow_move_constructible_v<typename Node::data_type>) : StaticNodePool() { take(std::move(other)); }
+
+            constexpr StaticNodePool& operator=(const StaticNodePool& other) {
+                if (this != &other) { destroyPayloads(); take(other); }
+                return *this;
+            }
+
+            constexpr StaticNodePool& operator=(StaticNodePool&& other) noexcept(std::is_nothrow_move_constructible_v<typename Node::data_type>) {
+                if (this != &other) { destroyPayloads(); take(std::move(other)); }
+                return *this;
+            }
+
+            constexpr ~StaticNodePool() { destroyPayloads(); }
+
+            // Destroys every live payload and empties the pool; generations are left for reuse.
+            constexpr void destroyPayloads() {
+                for (DagIndexType i = 0; i < nodeCount; i++) {
+                    if (generations[i] != 0) std::destroy_at(&nodes[i].data);
+                }
+                nodeCount = 0;
+            }
+
+            // Fills an empty pool from `other`, copying or moving its payloads slot by slot.
+            template<typename Pool>
+            constexpr void take(Pool&& other) {
+                generations = other.generations;
+                for (DagIndexType i = 0; i < other.nodeCount; i++) {
+                    nodes[i].firstEdge = other.nodes[i].firstEdge;
+                    if (generations[i] != 0) std::construct_at(&nodes[i].data, std::forward<Pool>(other).nodes[i].data);
+                    nodeCount = i + 1;
+                }
+            }
+        };
+    } // namespace detail
+
+    struct ReachabilityIndex; // the containers let its checked addEdge report rejections
+
+    // Storage indices use the narrowest unsigned type fitting MaxNodes/MaxEdges; Flags = void drops
+    // the per-edge flags. Payloads are constructed only when their node is added.
+    template<typename T, size_t MaxNodes, size_t MaxEdges, typename Flags = DagEdgeFlags, typename Stats = NoStats>
+    struct StaticDAG : private detail::StaticNodePool<detail::StaticNode<T, detail::smallest_index_t<(MaxNodes > MaxEdges ? MaxNodes : MaxEdges)>>, MaxNodes> {
+        using data_type = T;
+        using index_type = detail::smallest_index_t<(MaxNodes > MaxEdges ? MaxNodes : MaxEdges)>;
+        using flags_type = Flags;
+        using stats_type = Stats;
+
+        static constexpr DagIndexType npos = -1;
+        static constexpr index_type noEdge = static_cast<index_type>(-1); // end of an edge chain
+
+        using Node = detail::StaticNode<T, index_type>;
+        using Edge = detail::StaticEdge<index_type, Flags>;
+
+    private:
+        using NodePool = detail::StaticNodePool<Node, MaxNodes>;
+
+    public:
+        using NodePool::nodes;
+        std::array<Edge, MaxEdges> edges{};
+        DagIndexType edgeCount = 0; // live edges
+        using NodePool::nodeCount;
+        const char* lastError = nullptr;
+
+        // Counters of the stats policy (see NoStats and CountingStats).
+        constexpr Stats& stats() { return statistics.value; }
+        constexpr const Stats& stats() const { return statistics.value; }
+
+        // === Customizable reachability function ===
+        // Filters are template parameters; ReachableFn is the type-erased form.
+        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, const Edge& edge)>;
+
+        constexpr void clear() {
+            lastError = nullptr;
+            edgeCount = 0;
+            this->destroyPayloads();
+            edgeSlots = 0;
+            freeEdges = noEdge;
+            freeNodeCount = 0;
+            liveOrder.clear();
+        }
+
+        // Bound of the node index range. Removed slots stay inside it (contains() is false for them)
+        // until addNode recycles them.
+        constexpr DagIndexType size() const { return nodeCount; }
+        constexpr DagIndexType liveNodeCount() const { return nodeCount - freeNodeCount; }
+
+        constexpr bool contains(DagIndexType node) const { return node < nodeCount && generations[node] != 0; }
+
+        constexpr bool contains(NodeHandle node) const {
+            return node.generation != 0 && node.index < nodeCount && generations[node.index] == node.generation;
+        }
+
+        // Handle for a live node, or a null handle (contains() false) for anything else.
+        constexpr NodeHandle handle(DagIndexType node) const {
+            return contains(node) ? NodeHandle{ node, generations[node] } : NodeHandle{};
+        }
+
+        // Calls fn(to, edge) for every outgoing edge of `from`.
+        template<typename Fn>
+        constexpr void forEachEdge(DagIndexType from, Fn&& fn) const {
+            statistics.hooks().onNodeVisited();
+            for (index_type e = nodes[from].firstEdge; e != noEdge; e = edges[e].next) {
+                statistics.hooks().onEdgeScanned();
+                fn(DagIndexType(edges[e].to), edges[e]);
+            }
+        }
+
+        // === Opt-in incremental topological order ===
+        // addEdge then only searches between the endpoints of an edge that contradicts the order.
+        constexpr void enableIncrementalOrder() { liveOrder.reset(topologicalSort(), size()); }
+        constexpr void disableIncrementalOrder() { liveOrder = {}; }
+        constexpr bool incrementalOrderEnabled() const { return liveOrder.enabled; }
+
+        // Current live order (position -> node); empty unless incremental order is enabled. Removed
+        // slots keep their position so that recycling them needs no reordering.
+        constexpr const std::vector<DagIndexType>& incrementalOrder() const { return liveOrder.order; }
+
+        template<typename Filter = NoFilter>
+        constexpr bool reachable(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            return detail::reachable(*this, from, target, counted(edgeFilter));
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            return detail::reachable(*this, from, target, ws, counted(edgeFilter));
+        }
+
+        // === Opt-in predecessor lists ===
+        // Reverse edge chains kept in sync on every edit: two index_type per edge slot, one per node.
+        constexpr void enablePredecessors() {
+            trackPredecessors = true;
+            firstInEdge.assign(MaxNodes, noEdge);
+            inEdges.assign(MaxEdges, {});
+            for (DagIndexType u = 0; u < nodeCount; u++) {
+                for (index_type e = nodes[u].firstEdge; e != noEdge; e = edges[e].next) linkIn(e, u);
+            }
+        }
+
+        constexpr void disablePredecessors() {
+            trackPredecessors = false;
+            firstInEdge = {};
+            inEdges = {};
+        }
+
+        constexpr bool predecessorsEnabled() const { return trackPredecessors; }
+
+        // Calls fn(from, edge) for every incoming edge of `to`; requires enablePredecessors(). A
+        // callback returning bool ends the enumeration by returning false.
+        template<typename Fn>
+        constexpr void forEachInEdge(DagIndexType to, Fn&& fn) const {
+            statistics.hooks().onNodeVisited();
+            for (index_type e = firstInEdge[to]; e != noEdge; e = inEdges[e].next) {
+                statistics.hooks().onEdgeScanned();
+                if (!detail::proceed(fn, DagIndexType(inEdges[e].from), edges[e])) return;
+            }
+        }
+
+        // Meets in the middle when predecessors are enabled, otherwise same as reachable().
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            if (!trackPredecessors) return detail::reachable(*this, from, target, ws, counted(edgeFilter));
+            return detail::reachableBidirectional(*this, from, target, ws, counted(edgeFilter));
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            Workspace ws;
+            return reachableBidirectional(from, target, ws, edgeFilter);
+        }
+
+        constexpr DagIndexType addNode(const T& data) { return emplaceNode(data); }
+        constexpr DagIndexType addNode(T&& data) { return emplaceNode(std::move(data)); }
+
+        // Adds a node whose payload is constructed in its slot from `args`. If that throws, the graph
+        // is left as it was.
+        template<typename... Args> requires std::is_constructible_v<T, Args...>
+        constexpr DagIndexType emplaceNode(Args&&... args) {
+            const DagIndexType node = nextSlot();
+            if (node == npos) { reject(Rejection::NodePoolFull); return npos; }
+            std::construct_at(&nodes[node].data, std::forward<Args>(args)...);
+            allocateNode();
+            nodes[node].firstEdge = noEdge;
+            return node;
+        }
+
+        constexpr T* addEdge(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::AddEdge);
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return nullptr; }
+            if (createsCycle(from, to)) { reject(Rejection::Cycle); return nullptr; }
+            if (edgeCount >= MaxEdges) { reject(Rejection::EdgePoolFull); return nullptr; }
+
+            link(from, to, flags);
+            return &nodes[from].data;
+        }
+
+        // Adds an edge without the cycle check, for callers that know it keeps the graph acyclic. An edge
+        // that closes a cycle anyway turns the incremental order off.
+        constexpr T* addEdgeUnchecked(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return nullptr; }
+            if (edgeCount >= MaxEdges) { reject(Rejection::EdgePoolFull); return nullptr; }
+            if (liveOrder.enabled && !liveOrder.insert(*this, from, to)) disableIncrementalOrder();
+
+            link(from, to, flags);
+            return &nodes[from].data;
+        }
+
+        // Adds a batch of edges with one Kahn pass instead of a DFS per edge, all or nothing: on a cycle
+        // nothing is added and `cycle`, if given, receives its nodes (v0 -> v1 -> ... -> v0).
+        constexpr bool addEdges(std::span<const EdgeSpec> batch, std::vector<DagIndexType>* cycle = nullptr) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::AddEdges);
+            for (auto& edge : batch) {
+                if (!contains(edge.from) || !contains(edge.to)) { reject(Rejection::InvalidNode); return false; }
+            }
+            if (batch.size() > MaxEdges - edgeCount) { reject(Rejection::EdgePoolFull); return false; }
+
+            for (auto& edge : batch) {
+                link(edge.from, edge.to, edge.flags);
+            }
+
+            auto order = topologicalSort();
+            if (order.size() != liveNodeCount()) {
+                if (cycle) *cycle = detail::findCycle(*this, order);
+                // Undo in reverse; each batch edge sits at the head of its chain when its turn comes.
+                for (auto it = batch.rbegin(); it != batch.rend(); ++it) release(nodes[it->from].firstEdge);
+                reject(Rejection::Cycle);
+                return false;
+            }
+
+            if (liveOrder.enabled) liveOrder.reset(std::move(order), size());
+            return true;
+        }
+
+        // === Removal ===
+        // Freed node and edge slots go on free lists that addNode/addEdge reuse first.
+
+        // Removes one from -> to edge, the most recently added one if there are duplicates.
+        constexpr bool removeEdge(DagIndexType from, DagIndexType to) {
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            for (index_type* link = &nodes[from].firstEdge; *link != noEdge; link = &edges[*link].next) {
+                if (edges[*link].to == to) { release(*link); return true; }
+            }
+            reject(Rejection::EdgeNotFound);
+            return false;
+        }
+
+        // Removes `node` and every edge touching it. Without predecessor lists the incoming edges are
+        // found by walking all edge chains, O(V + E). The slot is handed out again by a later addNode.
+        constexpr bool removeNode(DagIndexType node) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::RemoveNode);
+            if (!contains(node)) { reject(Rejection::InvalidNode); return false; }
+            while (nodes[node].firstEdge != noEdge) release(nodes[node].firstEdge);
+            if (trackPredecessors) {
+                while (firstInEdge[node] != noEdge) release(outLink(firstInEdge[node]));
+            }
+            else {
+                for (DagIndexType u = 0; u < nodeCount; u++) {
+                    for (index_type* link = &nodes[u].firstEdge; *link != noEdge;) {
+                        if (edges[*link].to == node) release(*link);
+                        else link = &edges[*link].next;
+                    }
+                }
+            }
+            std::destroy_at(&nodes[node].data);
+            generations[node] = 0;
+            freeNodes[freeNodeCount++] = static_cast<index_type>(node);
+            return true;
+        }
+
+        constexpr bool removeNode(NodeHandle node) {
+            if (!contains(node)) { reject(Rejection::StaleHandle); return false; }
+            return removeNode(node.index);
+        }
+
+        // Renumbers the live nodes into `policy` order and repacks the edge pool. Returns the new index
+        // of every old one (npos for removed slots); a handle h now reads { map[h.index], h.generation }.
+        constexpr std::vector<DagIndexType> reorder(Ordering policy = Ordering::Topological) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reorder);
+            const auto order = detail::ordering(*this, policy);
+            std::vector<DagIndexType> mapping(nodeCount, npos);
+            for (DagIndexType i = 0; i < order.size(); i++) mapping[order[i]] = i;
+
+            std::vector<T> data;
+            data.reserve(order.size());
+            std::vector<index_type> firstEdges;
+            std::vector<uint32_t> permutedGenerations;
+            std::vector<Edge> packed;
+            firstEdges.reserve(order.size());
+            permutedGenerations.reserve(order.size());
+            packed.reserve(edgeCount);
+            for (auto old : order) {
+                const DagIndexType first = packed.size();
+                for (index_type e = nodes[old].firstEdge; e != noEdge; e = edges[e].next) {
+                    Edge edge = edges[e];
+                    edge.to = static_cast<index_type>(mapping[edge.to]);
+                    edge.next = static_cast<index_type>(packed.size() + 1);
+                    packed.push_back(edge);
+                }
+                if (packed.size() != first) packed.back().next = noEdge;
+                firstEdges.push_back(packed.size() != first ? static_cast<index_type>(first) : noEdge);
+                permutedGenerations.push_back(generations[old]);
+                data.push_back(std::move(nodes[old].data));
+            }
+
+            const DagIndexType slots = nodeCount;
+            this->destroyPayloads();
+            for (DagIndexType i = 0; i < order.size(); i++) {
+                std::construct_at(&nodes[i].data, std::move(data[i]));
+                nodes[i].firstEdge = firstEdges[i];
+                generations[i] = permutedGenerations[i];
+            }
+            for (DagIndexType i = order.size(); i < slots; i++) {
+                nodes[i].firstEdge = noEdge;
+                generations[i] = 0;
+            }
+            std::copy(packed.begin(), packed.end(), edges.begin());
+            nodeCount = order.size();
+            freeNodeCount = 0;
+            freeEdges = noEdge;
+            edgeSlots = packed.size();
+
+            if (trackPredecessors) enablePredecessors();
+            if (liveOrder.enabled) liveOrder.reset(topologicalSort(), size());
+            return mapping;
+        }
+
+        template<typename Filter = NoFilter>
+        constexpr std::vector<DagIndexType> topologicalSort(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            return detail::topologicalSort(*this, counted(edgeFilter));
+        }
+
+        // The same order padded with npos up to MaxNodes. Unlike the std::vector result it can outlive a
+        // constant evaluation, e.g. to initialise a constexpr array.
+        template<typename Filter = NoFilter>
+        constexpr std::array<DagIndexType, MaxNodes> topologicalSortFixed(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            std::array<DagIndexType, MaxNodes> fixed{};
+            fixed.fill(npos);
+            auto order = detail::topologicalSort(*this, counted(edgeFilter));
+            std::copy(order.begin(), order.end(), fixed.begin());
+            return fixed;
+        }
+
+        // Result is ws.order, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const std::vector<DagIndexType>& topologicalSort(Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            detail::topologicalSort(*this, counted(edgeFilter), ws.indegree, ws.order);
+            return ws.order;
+        }
+
+        template<typename Filter = NoFilter>
+        constexpr TopologicalLevels topologicalLevels(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalLevels);
+            return detail::topologicalLevels(*this, counted(edgeFilter));
+        }
+
+        // Result is ws.levels, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const TopologicalLevels& topologicalLevels(Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalLevels);
+            detail::topologicalLevels(*this, counted(edgeFilter), ws.indegree, ws.levels);
+            return ws.levels;
+        }
+
+        template<typename Filter = NoFilter>
+        std::array<std::vector<DagIndexType>, MaxNodes> transitivelyReducePerNode(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TransitiveReduction);
+            std::array<std::vector<DagIndexType>, MaxNodes> reducedEdges;
+            detail::transitivelyReduce(*this, reducedEdges, counted(edgeFilter));
+            return reducedEdges;
+        }
+
+        // Writes into `reducedEdges`, reusing the capacity of its vectors and of the workspace.
+        template<typename Filter = NoFilter>
+        void transitivelyReducePerNode(std::array<std::vector<DagIndexType>, MaxNodes>& reducedEdges, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TransitiveReduction);
+            for (auto& successors : reducedEdges) successors.clear();
+            detail::transitivelyReduce(*this, reducedEdges, ws, counted(edgeFilter));
+        }
+
+    private:
+        friend struct ReachabilityIndex;
+        detail::IncrementalOrder liveOrder;
+        [[no_unique_address]] detail::StatsSlot<Stats> statistics;
+
+        struct InEdge {
+            index_type from;
+            index_type next;
+        };
+
+        using NodePool::generations;
+        std::array<index_type, MaxNodes> freeNodes{};
+        DagIndexType freeNodeCount = 0;
+        index_type freeEdges = noEdge;
+        DagIndexType edgeSlots = 0;                   // edge slots ever touched since clear()
+        uint32_t nextGeneration = 1;
+
+        bool trackPredecessors = false;
+        std::vector<index_type> firstInEdge; // per node slot, while predecessors are tracked
+        std::vector<InEdge> inEdges;         // per edge slot, parallel to `edges`
+
+        // The slot the next allocateNode() hands out, npos when the pool is full.
+        constexpr DagIndexType nextSlot() const {
+            if (freeNodeCount > 0) return freeNodes[freeNodeCount - 1];
+            return nodeCount < MaxNodes ? nodeCount : npos;
+        }
+
+        constexpr DagIndexType allocateNode() {
+            DagIndexType node;
+            if (freeNodeCount > 0) {
+                node = freeNodes[--freeNodeCount]; // keeps its position in the live order
+            }
+            else {
+                if (nodeCount >= MaxNodes) return npos;
+                node = nodeCount++;
+                if (liveOrder.enabled) liveOrder.push(node);
+            }
+            generations[node] = nextGeneration;
+            if (trackPredecessors) firstInEdge[node] = noEdge;
+            nextGeneration = nextGeneration == UINT32_MAX ? 1 : nextGeneration + 1;
+            return node;
+        }
+
+        constexpr void link(DagIndexType from, DagIndexType to, DagEdgeFlags flags) {
+            index_type e;
+            if (freeEdges != noEdge) { e = freeEdges; freeEdges = edges[e].next; }
+            else e = static_cast<index_type>(edgeSlots++);
+
+            auto& edge = edges[e];
+            edge.to = static_cast<index_type>(to);
+            edge.next = nodes[from].firstEdge;
+            if constexpr (!std::is_void_v<Flags>) edge.flags = static_cast<Flags>(flags);
+            nodes[from].firstEdge = e;
+            if (trackPredecessors) linkIn(e, from);
+            edgeCount++;
+        }
+
+        constexpr void linkIn(index_type e, DagIndexType from) {
+            auto& head = firstInEdge[edges[e].to];
+            inEdges[e] = { static_cast<index_type>(from), head };
+            head = e;
+        }
+
+        // The forward link (a firstEdge or a next field) pointing at edge slot `e`.
+        constexpr index_type& outLink(index_type e) {
+            index_type* link = &nodes[inEdges[e].from].firstEdge;
+            while (*link != e) link = &edges[*link].next;
+            return *link;
+        }
+
+        // Unlinks the edge `link` points at (a firstEdge or a next field) and frees its slot.
+        constexpr void release(index_type& link) {
+            const index_type e = link;
+            link = edges[e].next;
+            if (trackPredecessors) {
+                index_type* in = &firstInEdge[edges[e].to];
+                while (*in != e) in = &inEdges[*in].next;
+                *in = inEdges[e].next;
+            }
+            edges[e].next = freeEdges;
+            freeEdges = e;
+            edgeCount--;
+        }
+
+        // Sets lastError and reports the rejection to the stats policy.
+        constexpr void reject(Rejection reason) {
+            lastError = describe(reason);
+            statistics.hooks().onReject(reason);
+        }
+
+        template<typename Filter>
+        constexpr decltype(auto) counted(Filter& edgeFilter) const { return detail::countCalls(statistics.hooks(), edgeFilter); }
+
+        constexpr bool createsCycle(DagIndexType from, DagIndexType to) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::CycleCheck);
+            if (!liveOrder.enabled) return detail::reachable(*this, to, from, NoFilter{});
+            return !liveOrder.insert(*this, from, to);
+        }
+    };
+
+    template<size_t MaxNodes, size_t MaxEdges, typename Flags, typename Stats>
+    struct StaticDAG<void, MaxNodes, MaxEdges, Flags, Stats> {
+        using data_type = void;
+        using index_type = detail::smallest_index_t<(MaxNodes > MaxEdges ? MaxNodes : MaxEdges)>;
+        using flags_type = Flags;
+        using stats_type = Stats;
+
+        static constexpr DagIndexType npos = -1;
+        static constexpr index_type noEdge = static_cast<index_type>(-1); // end of an edge chain
+
+        struct Node {
+            using data_type = void;
+            index_type firstEdge = noEdge;
+        };
+
+        using Edge = detail::StaticEdge<index_type, Flags>;
+
+        std::array<Node, MaxNodes> nodes{};
+        std::array<Edge, MaxEdges> edges{};
+        DagIndexType edgeCount = 0; // live edges
+        DagIndexType nodeCount = 0; // node slots handed out, removed ones included (see size())
+        const char* lastError = nullptr;
+
+        // Counters of the stats policy (see NoStats and CountingStats).
+        constexpr Stats& stats() { return statistics.value; }
+        constexpr const Stats& stats() const { return statistics.value; }
+
+        // === Customizable reachability function ===
+        // Filters are template parameters; ReachableFn is the type-erased form.
+        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, const Edge& edge)>;
+
+        constexpr void clear() {
+            lastError = nullptr;
+            edgeCount = 0;
+            nodeCount = 0;
+            edgeSlots = 0;
+            freeEdges = noEdge;
+            freeNodeCount = 0;
+            liveOrder.clear();
+        }
+
+        // Bound of the node index range. Removed slots stay inside it (contains() is false for them)
+        // until addNode recycles them.
+        constexpr DagIndexType size() const { return nodeCount; }
+        constexpr DagIndexType liveNodeCount() const { return nodeCount - freeNodeCount; }
+
+        constexpr bool contains(DagIndexType node) const { return node < nodeCount && generations[node] != 0; }
+
+        constexpr bool contains(NodeHandle node) const {
+            return node.generation != 0 && node.index < nodeCount && generations[node.index] == node.generation;
+        }
+
+        // Handle for a live node, or a null handle (contains() false) for anything else.
+        constexpr NodeHandle handle(DagIndexType node) const {
+            return contains(node) ? NodeHandle{ node, generations[node] } : NodeHandle{};
+        }
+
+        // Calls fn(to, edge) for every outgoing edge of `from`.
+        template<typename Fn>
+        constexpr void forEachEdge(DagIndexType from, Fn&& fn) const {
+            statistics.hooks().onNodeVisited();
+            for (index_type e = nodes[from].firstEdge; e != noEdge; e = edges[e].next) {
+                statistics.hooks().onEdgeScanned();
+                fn(DagIndexType(edges[e].to), edges[e]);
+            }
+        }
+
+        // === Opt-in incremental topological order ===
+        // addEdge then only searches between the endpoints of an edge that contradicts the order.
+        constexpr void enableIncrementalOrder() { liveOrder.reset(topologicalSort(), size()); }
+        constexpr void disableIncrementalOrder() { liveOrder = {}; }
+        constexpr bool incrementalOrderEnabled() const { return liveOrder.enabled; }
+
+        // Current live order (position -> node); empty unless incremental order is enabled. Removed
+        // slots keep their position so that recycling them needs no reordering.
+        constexpr const std::vector<DagIndexType>& incrementalOrder() const { return liveOrder.order; }
+
+        template<typename Filter = NoFilter>
+        constexpr bool reachable(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            return detail::reachable(*this, from, target, counted(edgeFilter));
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            return detail::reachable(*this, from, target, ws, counted(edgeFilter));
+        }
+
+        // === Opt-in predecessor lists ===
+        // Reverse edge chains kept in sync on every edit: two index_type per edge slot, one per node.
+        constexpr void enablePredecessors() {
+            trackPredecessors = true;
+            firstInEdge.assign(MaxNodes, noEdge);
+            inEdges.assign(MaxEdges, {});
+            for (DagIndexType u = 0; u < nodeCount; u++) {
+                for (index_type e = nodes[u].firstEdge; e != noEdge; e = edges[e].next) linkIn(e, u);
+            }
+        }
+
+        constexpr void disablePredecessors() {
+            trackPredecessors = false;
+            firstInEdge = {};
+            inEdges = {};
+        }
+
+        constexpr bool predecessorsEnabled() const { return trackPredecessors; }
+
+        // Calls fn(from, edge) for every incoming edge of `to`; requires enablePredecessors(). A
+        // callback returning bool ends the enumeration by returning false.
+        template<typename Fn>
+        constexpr void forEachInEdge(DagIndexType to, Fn&& fn) const {
+            statistics.hooks().onNodeVisited();
+            for (index_type e = firstInEdge[to]; e != noEdge; e = inEdges[e].next) {
+                statistics.hooks().onEdgeScanned();
+                if (!detail::proceed(fn, DagIndexType(inEdges[e].from), edges[e])) return;
+            }
+        }
+
+        // Meets in the middle when predecessors are enabled, otherwise same as reachable().
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            if (!trackPredecessors) return detail::reachable(*this, from, target, ws, counted(edgeFilter));
+            return detail::reachableBidirectional(*this, from, target, ws, counted(edgeFilter));
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            Workspace ws;
+            return reachableBidirectional(from, target, ws, edgeFilter);
+        }
+
+        constexpr DagIndexType addNode() {
+            const DagIndexType node = allocateNode();
+            if (node == npos) { reject(Rejection::NodePoolFull); return npos; }
+            nodes[node] = { noEdge };
+            return node;
+        }
+
+        constexpr bool addEdge(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::AddEdge);
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            if (createsCycle(from, to)) { reject(Rejection::Cycle); return false; }
+            if (edgeCount >= MaxEdges) { reject(Rejection::EdgePoolFull); return false; }
+
+            link(from, to, flags);
+            return true;
+        }
+
+        // Adds an edge without the cycle check, for callers that know it keeps the graph acyclic. An edge
+        // that closes a cycle anyway turns the incremental order off.
+        constexpr bool addEdgeUnchecked(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            if (edgeCount >= MaxEdges) { reject(Rejection::EdgePoolFull); return false; }
+            if (liveOrder.enabled && !liveOrder.insert(*this, from, to)) disableIncrementalOrder();
+
+            link(from, to, flags);
+            return true;
+        }
+
+        // Adds a batch of edges with one Kahn pass instead of a DFS per edge, all or nothing: on a cycle
+        // nothing is added and `cycle`, if given, receives its nodes (v0 -> v1 -> ... -> v0).
+        constexpr bool addEdges(std::span<const EdgeSpec> batch, std::vector<DagIndexType>* cycle = nullptr) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::AddEdges);
+            for (auto& edge : batch) {
+                if (!contains(edge.from) || !contains(edge.to)) { reject(Rejection::InvalidNode); return false; }
+            }
+            if (batch.size() > MaxEdges - edgeCount) { reject(Rejection::EdgePoolFull); return false; }
+
+            for (auto& edge : batch) {
+                link(edge.from, edge.to, edge.flags);
+            }
+
+            auto order = topologicalSort();
+            if (order.size() != liveNodeCount()) {
+                if (cycle) *cycle = detail::findCycle(*this, order);
+                // Undo in reverse; each batch edge sits at the head of its chain when its turn comes.
+                for (auto it = batch.rbegin(); it != batch.rend(); ++it) release(nodes[it->from].firstEdge);
+                reject(Rejection::Cycle);
+                return false;
+            }
+
+            if (liveOrder.enabled) liveOrder.reset(std::move(order), size());
+            return true;
+        }
+
+        // === Removal ===
+        // Freed node and edge slots go on free lists that addNode/addEdge reuse first.
+
+        // Removes one from -> to edge, the most recently added one if there are duplicates.
+        constexpr bool removeEdge(DagIndexType from, DagIndexType to) {
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            for (index_type* link = &nodes[from].firstEdge; *link != noEdge; link = &edges[*link].next) {
+                if (edges[*link].to == to) { release(*link); return true; }
+            }
+            reject(Rejection::EdgeNotFound);
+            return false;
+        }
+
+        // Removes `node` and every edge touching it. Without predecessor lists the incoming edges are
+        // found by walking all edge chains, O(V + E). The slot is handed out again by a later addNode.
+        constexpr bool removeNode(DagIndexType node) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::RemoveNode);
+            if (!contains(node)) { reject(Rejection::InvalidNode); return false; }
+            while (nodes[node].firstEdge != noEdge) release(nodes[node].firstEdge);
+            if (trackPredecessors) {
+                while (firstInEdge[node] != noEdge) release(outLink(firstInEdge[node]));
+            }
+            else {
+                for (DagIndexType u = 0; u < nodeCount; u++) {
+                    for (index_type* link = &nodes[u].firstEdge; *link != noEdge;) {
+                        if (edges[*link].to == node) release(*link);
+                        else link = &edges[*link].next;
+                    }
+                }
+            }
+            generations[node] = 0;
+            freeNodes[freeNodeCount++] = static_cast<index_type>(node);
+            return true;
+        }
+
+        constexpr bool removeNode(NodeHandle node) {
+            if (!contains(node)) { reject(Rejection::StaleHandle); return false; }
+            return removeNode(node.index);
+        }
+
+        // Renumbers the live nodes into `policy` order and repacks the edge pool. Returns the new index
+        // of every old one (npos for removed slots); a handle h now reads { map[h.index], h.generation }.
+        constexpr std::vector<DagIndexType> reorder(Ordering policy = Ordering::Topological) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reorder);
+            const auto order = detail::ordering(*this, policy);
+            std::vector<DagIndexType> mapping(nodeCount, npos);
+            for (DagIndexType i = 0; i < order.size(); i++) mapping[order[i]] = i;
+
+            std::vector<index_type> firstEdges;
+            std::vector<uint32_t> permutedGenerations;
+            std::vector<Edge> packed;
+            firstEdges.reserve(order.size());
+            permutedGenerations.reserve(order.size());
+            packed.reserve(edgeCount);
+            for (auto old : order) {
+                const DagIndexType first = packed.size();
+                for (index_type e = nodes[old].firstEdge; e != noEdge; e = edges[e].next) {
+                    Edge edge = edges[e];
+                    edge.to = static_cast<index_type>(mapping[edge.to]);
+                    edge.next = static_cast<index_type>(packed.size() + 1);
+                    packed.push_back(edge);
+                }
+                if (packed.size() != first) packed.back().next = noEdge;
+                firstEdges.push_back(packed.size() != first ? static_cast<index_type>(first) : noEdge);
+                permutedGenerations.push_back(generations[old]);
+            }
+
+            for (DagIndexType i = 0; i < order.size(); i++) {
+                nodes[i].firstEdge = firstEdges[i];
+                generations[i] = permutedGenerations[i];
+            }
+            for (DagIndexType i = order.size(); i < nodeCount; i++) {
+                nodes[i] = Node{};
+                generations[i] = 0;
+            }
+            std::copy(packed.begin(), packed.end(), edges.begin());
+            nodeCount = order.size();
+            freeNodeCount = 0;
+            freeEdges = noEdge;
+            edgeSlots = packed.size();
+
+            if (trackPredecessors) enablePredecessors();
+            if (liveOrder.enabled) liveOrder.reset(topologicalSort(), size());
+            return mapping;
+        }
+
+        template<typename Filter = NoFilter>
+        constexpr std::vector<DagIndexType> topologicalSort(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            return detail::topologicalSort(*this, counted(edgeFilter));
+        }
+
+        // The same order padded with npos up to MaxNodes. Unlike the std::vector result it can outlive a
+        // constant evaluation, e.g. to initialise a constexpr array.
+        template<typename Filter = NoFilter>
+        constexpr std::array<DagIndexType, MaxNodes> topologicalSortFixed(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            std::array<DagIndexType, MaxNodes> fixed{};
+            fixed.fill(npos);
+            auto order = detail::topologicalSort(*this, counted(edgeFilter));
+            std::copy(order.begin(), order.end(), fixed.begin());
+            return fixed;
+        }
+
+        // Result is ws.order, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const std::vector<DagIndexType>& topologicalSort(Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            detail::topologicalSort(*this, counted(edgeFilter), ws.indegree, ws.order);
+            return ws.order;
+        }
+
+        template<typename Filter = NoFilter>
+        constexpr TopologicalLevels topologicalLevels(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalLevels);
+            return detail::topologicalLevels(*this, counted(edgeFilter));
+        }
+
+        // Result is ws.levels, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const TopologicalLevels& topologicalLevels(Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalLevels);
+            detail::topologicalLevels(*this, counted(edgeFilter), ws.indegree, ws.levels);
+            return ws.levels;
+        }
+
+        template<typename Filter = NoFilter>
+        std::array<std::vector<DagIndexType>, MaxNodes> transitivelyReducePerNode(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TransitiveReduction);
+            std::array<std::vector<DagIndexType>, MaxNodes> reducedEdges;
+            detail::transitivelyReduce(*this, reducedEdges, counted(edgeFilter));
+            return reducedEdges;
+        }
+
+        // Writes into `reducedEdges`, reusing the capacity of its vectors and of the workspace.
+        template<typename Filter = NoFilter>
+        void transitivelyReducePerNode(std::array<std::vector<DagIndexType>, MaxNodes>& reducedEdges, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TransitiveReduction);
+            for (auto& successors : reducedEdges) successors.clear();
+            detail::transitivelyReduce(*this, reducedEdges, ws, counted(edgeFilter));
+        }
+
+    private:
+        friend struct ReachabilityIndex;
+        detail::IncrementalOrder liveOrder;
+        [[no_unique_address]] detail::StatsSlot<Stats> statistics;
+
+        struct InEdge {
+            index_type from;
+            index_type next;
+        };
+
+        std::array<uint32_t, MaxNodes> generations{}; // 0 marks a free slot
+        std::array<index_type, MaxNodes> freeNodes{};
+        DagIndexType freeNodeCount = 0;
+        index_type freeEdges = noEdge;
+        DagIndexType edgeSlots = 0;                   // edge slots ever touched since clear()
+        uint32_t nextGeneration = 1;
+
+        bool trackPredecessors = false;
+        std::vector<index_type> firstInEdge; // per node slot, while predecessors are tracked
+        std::vector<InEdge> inEdges;         // per edge slot, parallel to `edges`
+
+        constexpr DagIndexType allocateNode() {
+            DagIndexType node;
+            if (freeNodeCount > 0) {
+                node = freeNodes[--freeNodeCount]; // keeps its position in the live order
+            }
+            else {
+                if (nodeCount >= MaxNodes) return npos;
+                node = nodeCount++;
+                if (liveOrder.enabled) liveOrder.push(node);
+            }
+            generations[node] = nextGeneration;
+            if (trackPredecessors) firstInEdge[node] = noEdge;
+            nextGeneration = nextGeneration == UINT32_MAX ? 1 : nextGeneration + 1;
+            return node;
+        }
+
+        constexpr void link(DagIndexType from, DagIndexType to, DagEdgeFlags flags) {
+            index_type e;
+            if (freeEdges != noEdge) { e = freeEdges; freeEdges = edges[e].next; }
+            else e = static_cast<index_type>(edgeSlots++);
+
+            auto& edge = edges[e];
+            edge.to = static_cast<index_type>(to);
+            edge.next = nodes[from].firstEdge;
+            if constexpr (!std::is_void_v<Flags>) edge.flags = static_cast<Flags>(flags);
+            nodes[from].firstEdge = e;
+            if (trackPredecessors) linkIn(e, from);
+            edgeCount++;
+        }
+
+        constexpr void linkIn(index_type e, DagIndexType from) {
+            auto& head = firstInEdge[edges[e].to];
+            inEdges[e] = { static_cast<index_type>(from), head };
+            head = e;
+        }
+
+        // The forward link (a firstEdge or a next field) pointing at edge slot `e`.
+        constexpr index_type& outLink(index_type e) {
+            index_type* link = &nodes[inEdges[e].from].firstEdge;
+            while (*link != e) link = &edges[*link].next;
+            return *link;
+        }
+
+        // Unlinks the edge `link` points at (a firstEdge or a next field) and frees its slot.
+        constexpr void release(index_type& link) {
+            const index_type e = link;
+            link = edges[e].next;
+            if (trackPredecessors) {
+                index_type* in = &firstInEdge[edges[e].to];
+                while (*in != e) in = &inEdges[*in].next;
+                *in = inEdges[e].next;
+            }
+            edges[e].next = freeEdges;
+            freeEdges = e;
+            edgeCount--;
+        }
+
+        // Sets lastError and reports the rejection to the stats policy.
+        constexpr void reject(Rejection reason) {
+            lastError = describe(reason);
+            statistics.hooks().onReject(reason);
+        }
+
+        template<typename Filter>
+        constexpr decltype(auto) counted(Filter& edgeFilter) const { return detail::countCalls(statistics.hooks(), edgeFilter); }
+
+        constexpr bool createsCycle(DagIndexType from, DagIndexType to) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::CycleCheck);
+            if (!liveOrder.enabled) return detail::reachable(*this, to, from, NoFilter{});
+            return !liveOrder.insert(*this, from, to);
+        }
+    };
+
+    template<typename T, typename Stats = NoStats, typename Allocator = std::allocator<std::byte>>
+    struct DynamicDAG {
+        using data_type = T;
+        using stats_type = Stats;
+        using allocator_type = Allocator;
+
+        static constexpr DagIndexType npos = -1;
+
+        // Successors of a node (and predecessors, when tracked): target + optional flags. The first
+        // DAG_INLINE_EDGES live inside the node.
+        using EdgeList = detail::SmallVector<std::pair<DagIndexType, DagEdgeFlags>, DAG_INLINE_EDGES, detail::rebind_alloc_t<Allocator, std::pair<DagIndexType, DagEdgeFlags>>>;
+
+        struct Node {
+            T data;
+            EdgeList edges;
+
+            template<typename... Args>
+            Node(std::in_place_t, EdgeList list, Args&&... args) : data(std::forward<Args>(args)...), edges(std::move(list)) {}
+        };
+
+        std::vector<Node, detail::rebind_alloc_t<Allocator, Node>> nodes;
+        const char* lastError = nullptr;
+
+        DynamicDAG() = default;
+
+        // Nodes, edge lists and the per-node bookkeeping are all allocated through (rebound copies of)
+        // `allocator`, e.g. a std::pmr::polymorphic_allocator over a per-request monotonic buffer.
+        explicit DynamicDAG(const Allocator& allocator) : nodes(allocator), generations(allocator), inEdges(allocator) {}
+
+        allocator_type get_allocator() const { return allocator_type(nodes.get_allocator()); }
+
+        // Preallocates `nodeCount` nodes, and edgeCount / nodeCount slots in each current and future
+        // edge list.
+        void reserve(DagIndexType nodeCount, DagIndexType edgeCount = 0) {
+            nodes.reserve(nodeCount);
+            generations.reserve(nodeCount);
+            if (trackPredecessors) inEdges.reserve(nodeCount);
+            edgesPerNode = nodeCount == 0 ? 0 : (edgeCount + nodeCount - 1) / nodeCount;
+            for (auto& node : nodes) node.edges.reserve(edgesPerNode);
+        }
+
+        // Counters of the stats policy (see NoStats and CountingStats).
+        Stats& stats() { return statistics.value; }
+        const Stats& stats() const { return statistics.value; }
+
+        // Any callable with this signature can be passed as an edge filter (see StaticDAG::ReachableFn).
+        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, uint32_t flags)>;
+
+        void clear() {
+            lastError = nullptr;
+            nodes.clear();
+            generations.clear();
+            inEdges.clear();
+            removedCount = 0;
+            liveOrder.clear();
+        }
+
+        // Bound of the node index range. Removed nodes stay inside it as tombstones (contains() is false
+        // for them) until compact().
+        DagIndexType size() const { return nodes.size(); }
+        DagIndexType liveNodeCount() const { return nodes.size() - removedCount; }
+
+        bool contains(DagIndexType node) const { return node < nodes.size() && generations[node] != 0; }
+
+        bool contains(NodeHandle node) const {
+            return node.generation != 0 && node.index < nodes.size() && generations[node.index] == node.generation;
+        }
+
+        // Handle for a live node, or a null handle (contains() false) for anything else.
+        NodeHandle handle(DagIndexType node) const {
+            return contains(node) ? NodeHandle{ node, generations[node] } : NodeHandle{};
+        }
+
+        // Calls fn(to, flags) for every outgoing edge of `from`.
+        template<typename Fn>
+        void forEachEdge(DagIndexType from, Fn&& fn) const {
+            statistics.hooks().onNodeVisited();
+            for (auto& [to, flags] : nodes[from].edges) {
+                statistics.hooks().onEdgeScanned();
+                fn(to, flags);
+            }
+        }
+
+        // === Opt-in incremental topological order ===
+        // addEdge then only searches between the endpoints of an edge that contradicts the order.
+        void enableIncrementalOrder() { liveOrder.reset(topologicalSort(), size()); }
+        void disableIncrementalOrder() { liveOrder = {}; }
+        bool incrementalOrderEnabled() const { return liveOrder.enabled; }
+
+        // Current live order (position -> node); empty unless incremental order is enabled. Tombstones
+        // keep their position until compact().
+        const std::vector<DagIndexType>& incrementalOrder() const { return liveOrder.order; }
+
+        DagIndexType addNode(const T& data) { return emplaceNode(data); }
+        DagIndexType addNode(T&& data) { return emplaceNode(std::move(data)); }
+
+        // Adds a node whose payload is constructed in place from `args`. If that throws, the graph is
+        // left as it was.
+        template<typename... Args> requires std::is_constructible_v<T, Args...>
+        DagIndexType emplaceNode(Args&&... args) {
+            EdgeList edges = edgeList(edgesPerNode);
+            EdgeList in = edgeList(trackPredecessors ? edgesPerNode : 0);
+            makeRoom(nodes);
+            makeRoom(generations);
+            if (trackPredecessors) makeRoom(inEdges);
+            nodes.emplace_back(std::in_place, std::move(edges), std::forward<Args>(args)...);
+            generations.push_back(nextGeneration);
+            if (trackPredecessors) inEdges.push_back(std::move(in));
+            nextGeneration = nextGeneration == UINT32_MAX ? 1 : nextGeneration + 1;
+            if (liveOrder.enabled) liveOrder.push(nodes.size() - 1);
+            return nodes.size() - 1;
+        }
+
+        bool addEdge(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::AddEdge);
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            if (createsCycle(from, to)) { reject(Rejection::Cycle); return false; }
+            link(from, to, flags);
+            return true;
+        }
+
+        // Adds an edge without the cycle check, for callers that know it keeps the graph acyclic. An edge
+        // that closes a cycle anyway turns the incremental order off.
+        bool addEdgeUnchecked(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            if (liveOrder.enabled && !liveOrder.insert(*this, from, to)) disableIncrementalOrder();
+            link(from, to, flags);
+            return true;
+        }
+
+        // Adds a batch of edges with one Kahn pass instead of a DFS per edge, all or nothing: on a cycle
+        // nothing is added and `cycle`, if given, receives its nodes (v0 -> v1 -> ... -> v0).
+        bool addEdges(std::span<const EdgeSpec> batch, std::vector<DagIndexType>* cycle = nullptr) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::AddEdges);
+            for (auto& edge : batch) {
+                if (!contains(edge.from) || !contains(edge.to)) { reject(Rejection::InvalidNode); return false; }
+            }
+
+            for (auto& edge : batch) link(edge.from, edge.to, edge.flags);
+
+            auto order = topologicalSort();
+            if (order.size() != liveNodeCount()) {
+                if (cycle) *cycle = detail::findCycle(*this, order);
+                for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+                    nodes[it->from].edges.pop_back();
+                    if (trackPredecessors) unlinkIn(it->from, it->to);
+                }
+                reject(Rejection::Cycle);
+                return false;
+            }
+
+            if (liveOrder.enabled) liveOrder.reset(std::move(order), size());
+            return true;
+        }
+
+        // === Removal ===
+        // Removed nodes become tombstones, keeping their data and index, until compact().
+
+        // Removes one from -> to edge, the most recently added one if there are duplicates.
+        bool removeEdge(DagIndexType from, DagIndexType to) {
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            auto& out = nodes[from].edges;
+            for (auto it = out.rbegin(); it != out.rend(); ++it) {
+                if (it->first == to) {
+                    out.erase(std::next(it).base());
+                    if (trackPredecessors) unlinkIn(from, to);
+                    return true;
+                }
+            }
+            reject(Rejection::EdgeNotFound);
+            return false;
+        }
+
+        // Removes `node` and every edge touching it. Without predecessor lists the incoming edges are
+        // found by scanning all edge lists, O(V + E).
+        bool removeNode(DagIndexType node) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::RemoveNode);
+            if (!contains(node)) { reject(Rejection::InvalidNode); return false; }
+            auto isNode = [&](const auto& edge) { return edge.first == node; };
+            if (trackPredecessors) {
+                for (auto& [to, flags] : nodes[node].edges) erase_if(inEdges[to], isNode);
+                for (auto& [from, flags] : inEdges[node]) erase_if(nodes[from].edges, isNode);
+                inEdges[node] = edgeList();
+            }
+            else {
+                for (auto& other : nodes) erase_if(other.edges, isNode);
+            }
+            nodes[node].edges = edgeList();
+            generations[node] = 0;
+            removedCount++;
+            return true;
+        }
+
+        bool removeNode(NodeHandle node) {
+            if (!contains(node)) { reject(Rejection::StaleHandle); return false; }
+            return removeNode(node.index);
+        }
+
+        // Drops the tombstones, keeping the order of the rest. Returns old -> new index (npos if removed);
+        // handles of moved nodes stop resolving.
+        std::vector<DagIndexType> compact() {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Compact);
+            std::vector<DagIndexType> mapping(nodes.size(), npos);
+            DagIndexType next = 0;
+            for (DagIndexType i = 0; i < nodes.size(); i++) if (generations[i] != 0) mapping[i] = next++;
+
+            for (DagIndexType i = 0; i < nodes.size(); i++) {
+                if (mapping[i] == npos) continue;
+                for (auto& edge : nodes[i].edges) edge.first = mapping[edge.first];
+                if (trackPredecessors) for (auto& edge : inEdges[i]) edge.first = mapping[edge.first];
+                if (mapping[i] != i) {
+                    nodes[mapping[i]] = std::move(nodes[i]);
+                    generations[mapping[i]] = generations[i];
+                    if (trackPredecessors) inEdges[mapping[i]] = std::move(inEdges[i]);
+                }
+            }
+            nodes.erase(nodes.begin() + next, nodes.end());
+            generations.resize(next);
+            if (trackPredecessors) inEdges.erase(inEdges.begin() + next, inEdges.end());
+            removedCount = 0;
+
+            if (liveOrder.enabled) liveOrder.reset(topologicalSort(), size());
+            return mapping;
+        }
+
+        // Renumbers the live nodes into `policy` order, dropping removed slots. Returns the new index
+        // of every old one (npos for removed slots); a handle h now reads { map[h.index], h.generation }.
+        std::vector<DagIndexType> reorder(Ordering policy = Ordering::Topological) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reorder);
+            const auto order = detail::ordering(*this, policy);
+            std::vector<DagIndexType> mapping(nodes.size(), npos);
+            for (DagIndexType i = 0; i < order.size(); i++) mapping[order[i]] = i;
+
+            decltype(nodes) permuted(nodes.get_allocator());
+            decltype(generations) permutedGenerations(generations.get_allocator());
+            permuted.reserve(order.size());
+            permutedGenerations.reserve(order.size());
+            for (auto old : order) {
+                for (auto& edge : nodes[old].edges) edge.first = mapping[edge.first];
+                permuted.push_back(std::move(nodes[old]));
+                permutedGenerations.push_back(generations[old]);
+            }
+            nodes = std::move(permuted);
+            generations = std::move(permutedGenerations);
+
+            if (trackPredecessors) {
+                decltype(inEdges) permutedIn(inEdges.get_allocator());
+                permutedIn.reserve(order.size());
+                for (auto old : order) {
+                    for (auto& edge : inEdges[old]) edge.first = mapping[edge.first];
+                    permutedIn.push_back(std::move(inEdges[old]));
+                }
+                inEdges = std::move(permutedIn);
+            }
+            removedCount = 0;
+
+            if (liveOrder.enabled) liveOrder.reset(topologicalSort(), size());
+            return mapping;
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            return detail::reachable(*this, from, target, counted(edgeFilter));
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            return detail::reachable(*this, from, target, ws, counted(edgeFilter));
+        }
+
+        // === Opt-in predecessor lists ===
+        // Incoming-edge lists kept in sync on every edit; doubles the edge storage.
+        void enablePredecessors() {
+            trackPredecessors = true;
+            inEdges.assign(nodes.size(), edgeList());
+            for (DagIndexType u = 0; u < nodes.size(); u++) {
+                for (auto& [to, flags] : nodes[u].edges) append(inEdges[to], u, flags);
+            }
+        }
+
+        void disablePredecessors() {
+            trackPredecessors = false;
+            inEdges.clear();
+            inEdges.shrink_to_fit();
+        }
+
+        bool predecessorsEnabled() const { return trackPredecessors; }
+
+        // Calls fn(from, flags) for every incoming edge of `to`; requires enablePredecessors(). A
+        // callback returning bool ends the enumeration by returning false.
+        template<typename Fn>
+        void forEachInEdge(DagIndexType to, Fn&& fn) const {
+            statistics.hooks().onNodeVisited();
+            for (auto& [from, flags] : inEdges[to]) {
+                statistics.hooks().onEdgeScanned();
+                if (!detail::proceed(fn, from, flags)) return;
+            }
+        }
+
+        // Meets in the middle when predecessors are enabled, otherwise same as reachable().
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            if (!trackPredecessors) return detail::reachable(*this, from, target, ws, counted(edgeFilter));
+            return detail::reachableBidirectional(*this, from, target, ws, counted(edgeFilter));
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            Workspace ws;
+            return reachableBidirectional(from, target, ws, edgeFilter);
+        }
+
+        template<typename Filter = NoFilter>
+        std::vector<DagIndexType> topologicalSort(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            return detail::topologicalSort(*this, counted(edgeFilter));
+        }
+
+        // Result is ws.order, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const std::vector<DagIndexType>& topologicalSort(Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            detail::topologicalSort(*this, counted(edgeFilter), ws.indegree, ws.order);
+            return ws.order;
+        }
+
+        template<typename Filter = NoFilter>
+        TopologicalLevels topologicalLevels(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalLevels);
+            return detail::topologicalLevels(*this, counted(edgeFilter));
+        }
+
+        // Result is ws.levels, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const TopologicalLevels& topologicalLevels(Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalLevels);
+            detail::topologicalLevels(*this, counted(edgeFilter), ws.indegree, ws.levels);
+            return ws.levels;
+        }
+
+        template<typename Filter = NoFilter>
+        std::vector<std::vector<DagIndexType>> transitivelyReducePerNode(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TransitiveReduction);
+            std::vector<std::vector<DagIndexType>> reducedEdges(nodes.size());
+            detail::transitivelyReduce(*this, reducedEdges, counted(edgeFilter));
+            return reducedEdges;
+        }
+
+        // Writes into `reducedEdges`, reusing the capacity of its vectors and of the workspace.
+        template<typename Filter = NoFilter>
+        void transitivelyReducePerNode(std::vector<std::vector<DagIndexType>>& reducedEdges, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TransitiveReduction);
+            reducedEdges.resize(nodes.size());
+            for (auto& successors : reducedEdges) successors.clear();
+            detail::transitivelyReduce(*this, reducedEdges, ws, counted(edgeFilter));
+        }
+
+    private:
+        friend struct ReachabilityIndex;
+        detail::IncrementalOrder liveOrder;
+        [[no_unique_address]] detail::StatsSlot<Stats> statistics;
+
+        std::vector<uint32_t, detail::rebind_alloc_t<Allocator, uint32_t>> generations; // per node, 0 marks a tombstone
+        DagIndexType removedCount = 0;
+        uint32_t nextGeneration = 1;
+        DagIndexType edgesPerNode = 0; // initial edge list capacity, see reserve()
+
+        bool trackPredecessors = false;
+        std::vector<EdgeList, detail::rebind_alloc_t<Allocator, EdgeList>> inEdges; // source + flags, per node while tracked
+
+        void link(DagIndexType from, DagIndexType to, DagEdgeFlags flags) {
+            append(nodes[from].edges, to, flags);
+            if (trackPredecessors) append(inEdges[to], from, flags);
+        }
+
+        EdgeList edgeList(DagIndexType capacity = 0) const {
+            EdgeList list(nodes.get_allocator());
+            if (capacity > 0) list.reserve(capacity);
+            return list;
+        }
+
+        // emplace_back that reports reallocations to the stats policy.
+        template<typename Vector, typename... Args>
+        void append(Vector& v, Args&&... args) {
+            if constexpr (Stats::enabled) {
+                if (v.size() == v.capacity()) statistics.hooks().onAllocation();
+            }
+            v.emplace_back(std::forward<Args>(args)...);
+        }
+
+        // Grows `v` ahead of an insertion, so the insertion itself cannot fail half-way.
+        template<typename Vector>
+        void makeRoom(Vector& v) {
+            if (v.size() < v.capacity()) return;
+            if constexpr (Stats::enabled) statistics.hooks().onAllocation();
+            v.reserve(std::max<size_t>(2 * v.capacity(), 1));
+        }
+
+        // Drops the most recent from -> to entry of `to`'s incoming list, matching the forward edge
+        // removed alongside it.
+        void unlinkIn(DagIndexType from, DagIndexType to) {
+            auto& in = inEdges[to];
+            for (auto it = in.rbegin(); it != in.rend(); ++it) {
+                if (it->first == from) { in.erase(std::next(it).base()); return; }
+            }
+        }
+
+        // Sets lastError and reports the rejection to the stats policy.
+        void reject(Rejection reason) {
+            lastError = describe(reason);
+            statistics.hooks().onReject(reason);
+        }
+
+        template<typename Filter>
+        decltype(auto) counted(Filter& edgeFilter) const { return detail::countCalls(statistics.hooks(), edgeFilter); }
+
+        bool createsCycle(DagIndexType from, DagIndexType to) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::CycleCheck);
+            if (!liveOrder.enabled) return detail::reachable(*this, to, from, NoFilter{});
+            return !liveOrder.insert(*this, from, to);
+        }
+    };
+
+    template<typename Stats, typename Allocator>
+    struct DynamicDAG<void, Stats, Allocator> {
+        using data_type = void;
+        using stats_type = Stats;
+        using allocator_type = Allocator;
+
+        static constexpr DagIndexType npos = -1;
+
+        // Successors of a node (and predecessors, when tracked): target + optional flags. The first
+        // DAG_INLINE_EDGES live inside the node.
+        using EdgeList = detail::SmallVector<std::pair<DagIndexType, DagEdgeFlags>, DAG_INLINE_EDGES, detail::rebind_alloc_t<Allocator, std::pair<DagIndexType, DagEdgeFlags>>>;
+
+        struct Node {
+            EdgeList edges;
+        };
+
+        std::vector<Node, detail::rebind_alloc_t<Allocator, Node>> nodes;
+        const char* lastError = nullptr;
+
+        DynamicDAG() = default;
+
+        // Nodes, edge lists and the per-node bookkeeping are all allocated through (rebound copies of)
+        // `allocator`, e.g. a std::pmr::polymorphic_allocator over a per-request monotonic buffer.
+        explicit DynamicDAG(const Allocator& allocator) : nodes(allocator), generations(allocator), inEdges(allocator) {}
+
+        allocator_type get_allocator() const { return allocator_type(nodes.get_allocator()); }
+
+        // Preallocates `nodeCount` nodes, and edgeCount / nodeCount slots in each current and future
+        // edge list.
+        void reserve(DagIndexType nodeCount, DagIndexType edgeCount = 0) {
+            nodes.reserve(nodeCount);
+            generations.reserve(nodeCount);
+            if (trackPredecessors) inEdges.reserve(nodeCount);
+            edgesPerNode = nodeCount == 0 ? 0 : (edgeCount + nodeCount - 1) / nodeCount;
+            for (auto& node : nodes) node.edges.reserve(edgesPerNode);
+        }
+
+        // Counters of the stats policy (see NoStats and CountingStats).
+        Stats& stats() { return statistics.value; }
+        const Stats& stats() const { return statistics.value; }
+
+        // Any callable with this signature can be passed as an edge filter (see StaticDAG::ReachableFn).
+        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, uint32_t flags)>;
+
+        void clear() {
+            lastError = nullptr;
+            nodes.clear();
+            generations.clear();
+            inEdges.clear();
+            removedCount = 0;
+            liveOrder.clear();
+        }
+
+        // Bound of the node index range. Removed nodes stay inside it as tombstones (contains() is false
+        // for them) until compact().
+        DagIndexType size() const { return nodes.size(); }
+        DagIndexType liveNodeCount() const { return nodes.size() - removedCount; }
+
+        bool contains(DagIndexType node) const { return node < nodes.size() && generations[node] != 0; }
+
+        bool contains(NodeHandle node) const {
+            return node.generation != 0 && node.index < nodes.size() && generations[node.index] == node.generation;
+        }
+
+        // Handle for a live node, or a null handle (contains() false) for anything else.
+        NodeHandle handle(DagIndexType node) const {
+            return contains(node) ? NodeHandle{ node, generations[node] } : NodeHandle{};
+        }
+
+        // Calls fn(to, flags) for every outgoing edge of `from`.
+        template<typename Fn>
+        void forEachEdge(DagIndexType from, Fn&& fn) const {
+            statistics.hooks().onNodeVisited();
+            for (auto& [to, flags] : nodes[from].edges) {
+                statistics.hooks().onEdgeScanned();
+                fn(to, flags);
+            }
+        }
+
+        // === Opt-in incremental topological order ===
+        // addEdge then only searches between the endpoints of an edge that contradicts the order.
+        void enableIncrementalOrder() { liveOrder.reset(topologicalSort(), size()); }
+        void disableIncrementalOrder() { liveOrder = {}; }
+        bool incrementalOrderEnabled() const { return liveOrder.enabled; }
+
+        // Current live order (position -> node); empty unless incremental order is enabled. Tombstones
+        // keep their position until compact().
+        const std::vector<DagIndexType>& incrementalOrder() const { return liveOrder.order; }
+
+        DagIndexType addNode() {
+            append(nodes, Node{ edgeList(edgesPerNode) });
+            generations.push_back(nextGeneration);
+            nextGeneration = nextGeneration == UINT32_MAX ? 1 : nextGeneration + 1;
+            if (trackPredecessors) append(inEdges, edgeList(edgesPerNode));
+            if (liveOrder.enabled) liveOrder.push(nodes.size() - 1);
+            return nodes.size() - 1;
+        }
+
+        bool addEdge(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::AddEdge);
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            if (createsCycle(from, to)) { reject(Rejection::Cycle); return false; }
+            link(from, to, flags);
+            return true;
+        }
+
+        // Adds an edge without the cycle check, for callers that know it keeps the graph acyclic. An edge
+        // that closes a cycle anyway turns the incremental order off.
+        bool addEdgeUnchecked(DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            if (liveOrder.enabled && !liveOrder.insert(*this, from, to)) disableIncrementalOrder();
+            link(from, to, flags);
+            return true;
+        }
+
+        // Adds a batch of edges with one Kahn pass instead of a DFS per edge, all or nothing: on a cycle
+        // nothing is added and `cycle`, if given, receives its nodes (v0 -> v1 -> ... -> v0).
+        bool addEdges(std::span<const EdgeSpec> batch, std::vector<DagIndexType>* cycle = nullptr) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::AddEdges);
+            for (auto& edge : batch) {
+                if (!contains(edge.from) || !contains(edge.to)) { reject(Rejection::InvalidNode); return false; }
+            }
+
+            for (auto& edge : batch) link(edge.from, edge.to, edge.flags);
+
+            auto order = topologicalSort();
+            if (order.size() != liveNodeCount()) {
+                if (cycle) *cycle = detail::findCycle(*this, order);
+                for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+                    nodes[it->from].edges.pop_back();
+                    if (trackPredecessors) unlinkIn(it->from, it->to);
+                }
+                reject(Rejection::Cycle);
+                return false;
+            }
+
+            if (liveOrder.enabled) liveOrder.reset(std::move(order), size());
+            return true;
+        }
+
+        // === Removal ===
+        // Removed nodes become tombstones, keeping their index, until compact().
+
+        // Removes one from -> to edge, the most recently added one if there are duplicates.
+        bool removeEdge(DagIndexType from, DagIndexType to) {
+            if (!contains(from) || !contains(to)) { reject(Rejection::InvalidNode); return false; }
+            auto& out = nodes[from].edges;
+            for (auto it = out.rbegin(); it != out.rend(); ++it) {
+                if (it->first == to) {
+                    out.erase(std::next(it).base());
+                    if (trackPredecessors) unlinkIn(from, to);
+                    return true;
+                }
+            }
+            reject(Rejection::EdgeNotFound);
+            return false;
+        }
+
+        // Removes `node` and every edge touching it. Without predecessor lists the incoming edges are
+        // found by scanning all edge lists, O(V + E).
+        bool removeNode(DagIndexType node) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::RemoveNode);
+            if (!contains(node)) { reject(Rejection::InvalidNode); return false; }
+            auto isNode = [&](const auto& edge) { return edge.first == node; };
+            if (trackPredecessors) {
+                for (auto& [to, flags] : nodes[node].edges) erase_if(inEdges[to], isNode);
+                for (auto& [from, flags] : inEdges[node]) erase_if(nodes[from].edges, isNode);
+                inEdges[node] = edgeList();
+            }
+            else {
+                for (auto& other : nodes) erase_if(other.edges, isNode);
+            }
+            nodes[node].edges = edgeList();
+            generations[node] = 0;
+            removedCount++;
+            return true;
+        }
+
+        bool removeNode(NodeHandle node) {
+            if (!contains(node)) { reject(Rejection::StaleHandle); return false; }
+            return removeNode(node.index);
+        }
+
+        // Drops the tombstones, keeping the order of the rest. Returns old -> new index (npos if removed);
+        // handles of moved nodes stop resolving.
+        std::vector<DagIndexType> compact() {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Compact);
+            std::vector<DagIndexType> mapping(nodes.size(), npos);
+            DagIndexType next = 0;
+            for (DagIndexType i = 0; i < nodes.size(); i++) if (generations[i] != 0) mapping[i] = next++;
+
+            for (DagIndexType i = 0; i < nodes.size(); i++) {
+                if (mapping[i] == npos) continue;
+                for (auto& edge : nodes[i].edges) edge.first = mapping[edge.first];
+                if (trackPredecessors) for (auto& edge : inEdges[i]) edge.first = mapping[edge.first];
+                if (mapping[i] != i) {
+                    nodes[mapping[i]] = std::move(nodes[i]);
+                    generations[mapping[i]] = generations[i];
+                    if (trackPredecessors) inEdges[mapping[i]] = std::move(inEdges[i]);
+                }
+            }
+            nodes.erase(nodes.begin() + next, nodes.end());
+            generations.resize(next);
+            if (trackPredecessors) inEdges.erase(inEdges.begin() + next, inEdges.end());
+            removedCount = 0;
+
+            if (liveOrder.enabled) liveOrder.reset(topologicalSort(), size());
+            return mapping;
+        }
+
+        // Renumbers the live nodes into `policy` order, dropping removed slots. Returns the new index
+        // of every old one (npos for removed slots); a handle h now reads { map[h.index], h.generation }.
+        std::vector<DagIndexType> reorder(Ordering policy = Ordering::Topological) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reorder);
+            const auto order = detail::ordering(*this, policy);
+            std::vector<DagIndexType> mapping(nodes.size(), npos);
+            for (DagIndexType i = 0; i < order.size(); i++) mapping[order[i]] = i;
+
+            decltype(nodes) permuted(nodes.get_allocator());
+            decltype(generations) permutedGenerations(generations.get_allocator());
+            permuted.reserve(order.size());
+            permutedGenerations.reserve(order.size());
+            for (auto old : order) {
+                for (auto& edge : nodes[old].edges) edge.first = mapping[edge.first];
+                permuted.push_back(std::move(nodes[old]));
+                permutedGenerations.push_back(generations[old]);
+            }
+            nodes = std::move(permuted);
+            generations = std::move(permutedGenerations);
+
+            if (trackPredecessors) {
+                decltype(inEdges) permutedIn(inEdges.get_allocator());
+                permutedIn.reserve(order.size());
+                for (auto old : order) {
+                    for (auto& edge : inEdges[old]) edge.first = mapping[edge.first];
+                    permutedIn.push_back(std::move(inEdges[old]));
+                }
+                inEdges = std::move(permutedIn);
+            }
+            removedCount = 0;
+
+            if (liveOrder.enabled) liveOrder.reset(topologicalSort(), size());
+            return mapping;
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            return detail::reachable(*this, from, target, counted(edgeFilter));
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            return detail::reachable(*this, from, target, ws, counted(edgeFilter));
+        }
+
+        // === Opt-in predecessor lists ===
+        // Incoming-edge lists kept in sync on every edit; doubles the edge storage.
+        void enablePredecessors() {
+            trackPredecessors = true;
+            inEdges.assign(nodes.size(), edgeList());
+            for (DagIndexType u = 0; u < nodes.size(); u++) {
+                for (auto& [to, flags] : nodes[u].edges) append(inEdges[to], u, flags);
+            }
+        }
+
+        void disablePredecessors() {
+            trackPredecessors = false;
+            inEdges.clear();
+            inEdges.shrink_to_fit();
+        }
+
+        bool predecessorsEnabled() const { return trackPredecessors; }
+
+        // Calls fn(from, flags) for every incoming edge of `to`; requires enablePredecessors(). A
+        // callback returning bool ends the enumeration by returning false.
+        template<typename Fn>
+        void forEachInEdge(DagIndexType to, Fn&& fn) const {
+            statistics.hooks().onNodeVisited();
+            for (auto& [from, flags] : inEdges[to]) {
+                statistics.hooks().onEdgeScanned();
+                if (!detail::proceed(fn, from, flags)) return;
+            }
+        }
+
+        // Meets in the middle when predecessors are enabled, otherwise same as reachable().
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::Reachable);
+            if (!trackPredecessors) return detail::reachable(*this, from, target, ws, counted(edgeFilter));
+            return detail::reachableBidirectional(*this, from, target, ws, counted(edgeFilter));
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            Workspace ws;
+            return reachableBidirectional(from, target, ws, edgeFilter);
+        }
+
+        template<typename Filter = NoFilter>
+        std::vector<DagIndexType> topologicalSort(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            return detail::topologicalSort(*this, counted(edgeFilter));
+        }
+
+        // Result is ws.order, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const std::vector<DagIndexType>& topologicalSort(Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalSort);
+            detail::topologicalSort(*this, counted(edgeFilter), ws.indegree, ws.order);
+            return ws.order;
+        }
+
+        template<typename Filter = NoFilter>
+        TopologicalLevels topologicalLevels(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalLevels);
+            return detail::topologicalLevels(*this, counted(edgeFilter));
+        }
+
+        // Result is ws.levels, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const TopologicalLevels& topologicalLevels(Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TopologicalLevels);
+            detail::topologicalLevels(*this, counted(edgeFilter), ws.indegree, ws.levels);
+            return ws.levels;
+        }
+
+        template<typename Filter = NoFilter>
+        std::vector<std::vector<DagIndexType>> transitivelyReducePerNode(Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TransitiveReduction);
+            std::vector<std::vector<DagIndexType>> reducedEdges(nodes.size());
+            detail::transitivelyReduce(*this, reducedEdges, counted(edgeFilter));
+            return reducedEdges;
+        }
+
+        // Writes into `reducedEdges`, reusing the capacity of its vectors and of the workspace.
+        template<typename Filter = NoFilter>
+        void transitivelyReducePerNode(std::vector<std::vector<DagIndexType>>& reducedEdges, Workspace& ws, Filter&& edgeFilter = {}) const {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::TransitiveReduction);
+            reducedEdges.resize(nodes.size());
+            for (auto& successors : reducedEdges) successors.clear();
+            detail::transitivelyReduce(*this, reducedEdges, ws, counted(edgeFilter));
+        }
+
+    private:
+        friend struct ReachabilityIndex;
+        detail::IncrementalOrder liveOrder;
+        [[no_unique_address]] detail::StatsSlot<Stats> statistics;
+
+        std::vector<uint32_t, detail::rebind_alloc_t<Allocator, uint32_t>> generations; // per node, 0 marks a tombstone
+        DagIndexType removedCount = 0;
+        uint32_t nextGeneration = 1;
+        DagIndexType edgesPerNode = 0; // initial edge list capacity, see reserve()
+
+        bool trackPredecessors = false;
+        std::vector<EdgeList, detail::rebind_alloc_t<Allocator, EdgeList>> inEdges; // source + flags, per node while tracked
+
+        void link(DagIndexType from, DagIndexType to, DagEdgeFlags flags) {
+            append(nodes[from].edges, to, flags);
+            if (trackPredecessors) append(inEdges[to], from, flags);
+        }
+
+        EdgeList edgeList(DagIndexType capacity = 0) const {
+            EdgeList list(nodes.get_allocator());
+            if (capacity > 0) list.reserve(capacity);
+            return list;
+        }
+
+        // emplace_back that reports reallocations to the stats policy.
+        template<typename Vector, typename... Args>
+        void append(Vector& v, Args&&... args) {
+            if constexpr (Stats::enabled) {
+                if (v.size() == v.capacity()) statistics.hooks().onAllocation();
+            }
+            v.emplace_back(std::forward<Args>(args)...);
+        }
+
+        // Drops the most recent from -> to entry of `to`'s incoming list, matching the forward edge
+        // removed alongside it.
+        void unlinkIn(DagIndexType from, DagIndexType to) {
+            auto& in = inEdges[to];
+            for (auto it = in.rbegin(); it != in.rend(); ++it) {
+                if (it->first == from) { in.erase(std::next(it).base()); return; }
+            }
+        }
+
+        // Sets lastError and reports the rejection to the stats policy.
+        void reject(Rejection reason) {
+            lastError = describe(reason);
+            statistics.hooks().onReject(reason);
+        }
+
+        template<typename Filter>
+        decltype(auto) counted(Filter& edgeFilter) const { return detail::countCalls(statistics.hooks(), edgeFilter); }
+
+        bool createsCycle(DagIndexType from, DagIndexType to) {
+            [[maybe_unused]] auto timer = statistics.hooks().time(Operation::CycleCheck);
+            if (!liveOrder.enabled) return detail::reachable(*this, to, from, NoFilter{});
+            return !liveOrder.insert(*this, from, to);
+        }
+    };
+
+    namespace pmr
+    {
+        // DynamicDAG allocating from a std::pmr::memory_resource passed to its constructor.
+        template<typename T, typename Stats = NoStats>
+        using DynamicDAG = dag::DynamicDAG<T, Stats, std::pmr::polymorphic_allocator<std::byte>>;
+    } // namespace pmr
+
+    // Frozen, read-only DAG in CSR form, built with freeze(): the successors of node i are
+    // targets[offsets[i] .. offsets[i + 1]), in the source's order.
+    template<typename T>
+    struct CsrDAG;
+
+    template<>
+    struct CsrDAG<void> {
+        using data_type = void;
+
+        static constexpr DagIndexType npos = -1;
+
+        std::vector<DagIndexType> offsets{ 0 };
+        std::vector<DagIndexType> targets;
+        std::vector<DagEdgeFlags> flags;
+
+        // Optional reverse adjacency (see buildPredecessors): the predecessors of node i are
+        // sources[inOffsets[i] .. inOffsets[i + 1]) with matching inFlags.
+        std::vector<DagIndexType> inOffsets;
+        std::vector<DagIndexType> sources;
+        std::vector<DagEdgeFlags> inFlags;
+
+        // Any callable with this signature can be passed as an edge filter (see StaticDAG::ReachableFn).
+        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, DagEdgeFlags flags)>;
+
+        DagIndexType nodeCount() const { return offsets.size() - 1; }
+        DagIndexType edgeCount() const { return targets.size(); }
+        DagIndexType size() const { return nodeCount(); }
+
+        std::span<const DagIndexType> successors(DagIndexType node) const {
+            return { targets.data() + offsets[node], targets.data() + offsets[node + 1] };
+        }
+
+        // Calls fn(to, flags) for every outgoing edge of `from`.
+        template<typename Fn>
+        void forEachEdge(DagIndexType from, Fn&& fn) const {
+            for (DagIndexType e = offsets[from]; e < offsets[from + 1]; e++) fn(targets[e], flags[e]);
+        }
+
+        // Builds the reverse arrays, enabling predecessors() and bidirectional reachability queries.
+        void buildPredecessors() {
+            const DagIndexType n = nodeCount();
+            inOffsets.assign(n + 1, 0);
+            for (auto to : targets) inOffsets[to + 1]++;
+            for (DagIndexType i = 0; i < n; i++) inOffsets[i + 1] += inOffsets[i];
+
+            sources.resize(targets.size());
+            inFlags.resize(targets.size());
+            std::vector<DagIndexType> cursor(inOffsets.begin(), inOffsets.end() - 1);
+            for (DagIndexType u = 0; u < n; u++) {
+                for (DagIndexType e = offsets[u]; e < offsets[u + 1]; e++) {
+                    const DagIndexType slot = cursor[targets[e]]++;
+                    sources[slot] = u;
+                    inFlags[slot] = flags[e];
+                }
+            }
+        }
+
+        bool hasPredecessors() const { return inOffsets.size() == offsets.size(); }
+
+        std::span<const DagIndexType> predecessors(DagIndexType node) const {
+            return { sources.data() + inOffsets[node], sources.data() + inOffsets[node + 1] };
+        }
+
+        // Calls fn(from, flags) for every incoming edge of `to`; requires buildPredecessors(). A
+        // callback returning bool ends the enumeration by returning false.
+        template<typename Fn>
+        void forEachInEdge(DagIndexType to, Fn&& fn) const {
+            for (DagIndexType e = inOffsets[to]; e < inOffsets[to + 1]; e++) {
+                if (!detail::proceed(fn, sources[e], inFlags[e])) return;
+            }
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            return detail::reachable(*this, from, target, edgeFilter);
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            return detail::reachable(*this, from, target, ws, edgeFilter);
+        }
+
+        // Meets in the middle when predecessors are built, otherwise same as reachable().
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            if (!hasPredecessors()) return detail::reachable(*this, from, target, ws, edgeFilter);
+            return detail::reachableBidirectional(*this, from, target, ws, edgeFilter);
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachableBidirectional(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            Workspace ws;
+            return reachableBidirectional(from, target, ws, edgeFilter);
+        }
+
+        template<typename Filter = NoFilter>
+        std::vector<DagIndexType> topologicalSort(Filter&& edgeFilter = {}) const {
+            return detail::topologicalSort(*this, edgeFilter);
+        }
+
+        // Result is ws.order, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const std::vector<DagIndexType>& topologicalSort(Workspace& ws, Filter&& edgeFilter = {}) const {
+            detail::topologicalSort(*this, edgeFilter, ws.indegree, ws.order);
+            return ws.order;
+        }
+
+        template<typename Filter = NoFilter>
+        TopologicalLevels topologicalLevels(Filter&& edgeFilter = {}) const {
+            return detail::topologicalLevels(*this, edgeFilter);
+        }
+
+        // Result is ws.levels, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const TopologicalLevels& topologicalLevels(Workspace& ws, Filter&& edgeFilter = {}) const {
+            detail::topologicalLevels(*this, edgeFilter, ws.indegree, ws.levels);
+            return ws.levels;
+        }
+
+        template<typename Filter = NoFilter>
+        std::vector<std::vector<DagIndexType>> transitivelyReducePerNode(Filter&& edgeFilter = {}) const {
+            std::vector<std::vector<DagIndexType>> reducedEdges(nodeCount());
+            detail::transitivelyReduce(*this, reducedEdges, edgeFilter);
+            return reducedEdges;
+        }
+
+        // Writes into `reducedEdges`, reusing the capacity of its vectors and of the workspace.
+        template<typename Filter = NoFilter>
+        void transitivelyReducePerNode(std::vector<std::vector<DagIndexType>>& reducedEdges, Workspace& ws, Filter&& edgeFilter = {}) const {
+            reducedEdges.resize(nodeCount());
+            for (auto& successors : reducedEdges) successors.clear();
+            detail::transitivelyReduce(*this, reducedEdges, ws, edgeFilter);
+        }
+    };
+
+    template<typename T>
+    struct CsrDAG : CsrDAG<void> {
+        using data_type = T;
+
+        struct Node {
+            T data;
+        };
+
+        std::vector<Node> nodes;
+    };
+
+    namespace detail
+    {
+        // DynamicDAG tombstones keep their payload until compact(); freed StaticDAG slots hold none.
+        template<typename DAG>
+        inline constexpr bool keepsRemovedPayloads = requires { typename DAG::EdgeList; };
+    } // namespace detail
+
+    // CSR copy of a StaticDAG or DynamicDAG with the same indices (removed slots become isolated
+    // nodes). Removed StaticDAG slots get T{}, which needs a default-constructible T.
+    template<typename DAG>
+    CsrDAG<typename DAG::data_type> freeze(const DAG& dag) {
+        CsrDAG<typename DAG::data_type> csr;
+
+        csr.offsets.reserve(dag.size() + 1);
+        for (DagIndexType i = 0; i < dag.size(); i++) {
+            dag.forEachEdge(i, [&](DagIndexType to, const auto& edge) {
+                csr.targets.push_back(to);
+                csr.flags.push_back(detail::edgeFlags(edge));
+            });
+            csr.offsets.push_back(csr.targets.size());
+        }
+
+        if constexpr (!std::is_void_v<typename DAG::data_type>) {
+            csr.nodes.reserve(csr.nodeCount());
+            using Data = typename DAG::data_type;
+            for (DagIndexType i = 0; i < csr.nodeCount(); i++) {
+                if constexpr (detail::keepsRemovedPayloads<DAG>) {
+                    csr.nodes.push_back({ dag.nodes[i].data });
+                }
+                else {
+                    static_assert(std::is_default_constructible_v<Data>, "freezing a StaticDAG needs default-constructible node data for removed slots");
+                    csr.nodes.push_back({ detail::isLive(dag, i) ? dag.nodes[i].data : Data{} });
+                }
+            }
+        }
+        return csr;
+    }
+
+    // The edges of `dag` matching `mask` in CSR form, without node data but with the same indices.
+    template<typename DAG>
+    CsrDAG<void> filteredView(const DAG& dag, FlagMask mask) {
+        CsrDAG<void> view;
+
+        view.offsets.reserve(dag.size() + 1);
+        for (DagIndexType i = 0; i < dag.size(); i++) {
+            dag.forEachEdge(i, [&](DagIndexType to, const auto& edge) {
+                const DagEdgeFlags flags = detail::edgeFlags(edge);
+                if (!mask.matches(flags)) return;
+                view.targets.push_back(to);
+                view.flags.push_back(flags);
+            });
+            view.offsets.push_back(view.targets.size());
+        }
+        if (detail::hasInEdges(dag)) view.buildPredecessors();
+        return view;
+    }
+
+    // Lazily built filteredView()s of one graph, one per mask. Call invalidate() after mutating the
+    // graph; view() references stay valid until then.
+    template<typename DAG>
+    class FlagViews {
+    public:
+        explicit FlagViews(const DAG& dag) : graph(&dag) {}
+
+        const CsrDAG<void>& view(FlagMask mask) {
+            for (auto& [key, cached] : views) {
+                if (key == mask) return cached;
+            }
+            return views.emplace_back(mask, filteredView(*graph, mask)).second;
+        }
+
+        void invalidate() { views.clear(); }
+
+        size_t cachedCount() const { return views.size(); }
+
+    private:
+        const DAG* graph;
+        std::deque<std::pair<FlagMask, CsrDAG<void>>> views;
+    };
+
+    // Every node reachable from any of `sources` (sources included), as a bitset valid until the
+    // workspace's next query.
+    template<typename DAG, typename Filter = NoFilter>
+    const DenseBitset& reachableSet(const DAG& dag, std::span<const DagIndexType> sources, Workspace& ws, Filter&& edgeFilter = {}) {
+        detail::reachableSet(dag, sources, ws, edgeFilter);
+        return ws.reached;
+    }
+
+    template<typename DAG, typename Filter = NoFilter>
+    DenseBitset reachableSet(const DAG& dag, std::span<const DagIndexType> sources, Filter&& edgeFilter = {}) {
+        Workspace ws;
+        detail::reachableSet(dag, sources, ws, edgeFilter);
+        return std::move(ws.reached);
+    }
+
+    // Calls fn(node) once for every node reachable from any of `sources`, sources included. A bool
+    // callback returning false stops the search, and this returns false.
+    template<typename DAG, typename Fn, typename Filter = NoFilter>
+    bool forEachDescendant(const DAG& dag, std::span<const DagIndexType> sources, Workspace& ws, Fn&& fn, Filter&& edgeFilter = {}) {
+        return detail::markDescendants(dag, sources, ws, fn, edgeFilter);
+    }
+
+    template<typename DAG, typename Fn, typename Filter = NoFilter>
+    bool forEachDescendant(const DAG& dag, std::span<const DagIndexType> sources, Fn&& fn, Filter&& edgeFilter = {}) {
+        Workspace ws;
+        return detail::markDescendants(dag, sources, ws, fn, edgeFilter);
+    }
+
+    // The same for every node that reaches any of `targets`.
+    template<typename DAG, typename Fn, typename Filter = NoFilter>
+    bool forEachAncestor(const DAG& dag, std::span<const DagIndexType> targets, Workspace& ws, Fn&& fn, Filter&& edgeFilter = {}) {
+        return detail::markAncestors(dag, targets, ws, fn, edgeFilter);
+    }
+
+    template<typename DAG, typename Fn, typename Filter = NoFilter>
+    bool forEachAncestor(const DAG& dag, std::span<const DagIndexType> targets, Fn&& fn, Filter&& edgeFilter = {}) {
+        Workspace ws;
+        return detail::markAncestors(dag, targets, ws, fn, edgeFilter);
+    }
+
+    // Closures as sorted node lists: everything reachable from `sources`, or reaching `targets`, the
+    // given nodes included. The overloads taking a Workspace write into `out`, reusing its capacity.
+    template<typename DAG, typename Filter = NoFilter>
+    void descendants(const DAG& dag, std::span<const DagIndexType> sources, std::vector<DagIndexType>& out, Workspace& ws, Filter&& edgeFilter = {}) {
+        detail::reachableSet(dag, sources, ws, edgeFilter);
+        out.clear();
+        ws.reached.forEach([&](DagIndexType node) { out.push_back(node); });
+    }
+
+    template<typename DAG, typename Filter = NoFilter>
+    std::vector<DagIndexType> descendants(const DAG& dag, std::span<const DagIndexType> sources, Filter&& edgeFilter = {}) {
+        std::vector<DagIndexType> out;
+        Workspace ws;
+        descendants(dag, sources, out, ws, edgeFilter);
+        return out;
+    }
+
+    template<typename DAG, typename Filter = NoFilter>
+    void ancestors(const DAG& dag, std::span<const DagIndexType> targets, std::vector<DagIndexType>& out, Workspace& ws, Filter&& edgeFilter = {}) {
+        auto none = [](DagIndexType) {};
+        detail::markAncestors(dag, targets, ws, none, edgeFilter);
+        out.clear();
+        ws.reached.forEach([&](DagIndexType node) { out.push_back(node); });
+    }
+
+    template<typename DAG, typename Filter = NoFilter>
+    std::vector<DagIndexType> ancestors(const DAG& dag, std::span<const DagIndexType> targets, Filter&& edgeFilter = {}) {
+        std::vector<DagIndexType> out;
+        Workspace ws;
+        ancestors(dag, targets, out, ws, edgeFilter);
+        return out;
+    }
+
+    // Some of a graph's nodes copied into a DynamicDAG of their own: node i of `graph` is node
+    // original[i] of the source. Nodes keep their relative order.
+    template<typename T>
+    struct Subgraph {
+        DynamicDAG<T> graph;
+        std::vector<DagIndexType> original;
+    };
+
+    // The subgraph induced by `nodes` (duplicates, removed and out-of-range indices ignored), with
+    // the edges among them that pass `edgeFilter`.
+    template<typename DAG, typename Filter = NoFilter>
+    Subgraph<typename DAG::data_type> extractSubgraph(const DAG& dag, std::span<const DagIndexType> nodes, Filter&& edgeFilter = {}) {
+        constexpr DagIndexType npos = -1;
+        const DagIndexType n = dag.size();
+        DenseBitset keep(n);
+        for (auto node : nodes) {
+            if (node < n && detail::isLive(dag, node)) keep.set(node);
+        }
+
+        Subgraph<typename DAG::data_type> sub;
+        std::vector<DagIndexType> renumbered(n, npos);
+        sub.original.reserve(keep.count());
+        keep.forEach([&](DagIndexType node) {
+            renumbered[node] = sub.original.size();
+            sub.original.push_back(node);
+        });
+
+        sub.graph.reserve(sub.original.size());
+        for (auto node : sub.original) {
+            if constexpr (std::is_void_v<typename DAG::data_type>) sub.graph.addNode();
+            else sub.graph.addNode(dag.nodes[node].data);
+        }
+        for (auto node : sub.original) {
+            dag.forEachEdge(node, [&](DagIndexType to, const auto& edge) {
+                if (renumbered[to] != npos && detail::passes(edgeFilter, node, to, edge)) {
+                    sub.graph.addEdgeUnchecked(renumbered[node], renumbered[to], detail::edgeFlags(edge));
+                }
+            });
+        }
+        return sub;
+    }
+
+    // Transitive closure, one bitset row per node (nodeCount^2 / 8 bytes): reachable() is a bit test.
+    // A snapshot kept in sync only by its own addNode/addEdge; anything else needs build() again.
+    struct ReachabilityIndex {
+        ReachabilityIndex() = default;
+
+        template<typename DAG, typename Filter = NoFilter>
+        explicit ReachabilityIndex(const DAG& dag, Filter&& edgeFilter = {}) {
+            build(dag, edgeFilter);
+        }
+
+        template<typename DAG, typename Filter = NoFilter>
+        void build(const DAG& dag, Filter&& edgeFilter = {}) {
+            count = dag.size();
+            closure.assign(count, count);
+            generations.clear();
+            recordGenerations(dag);
+
+            auto order = detail::topologicalSort(dag, edgeFilter);
+            for (auto it = order.rbegin(); it != order.rend(); ++it) {
+                const DagIndexType u = *it;
+                closure.set(u, u);
+                dag.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (detail::passes(edgeFilter, u, to, edge)) closure.merge(u, to);
+                });
+            }
+        }
+
+        DagIndexType nodeCount() const { return count; }
+        size_t memoryBytes() const { return closure.bits.size() * sizeof(uint64_t); }
+
+        bool reachable(DagIndexType from, DagIndexType target) const {
+            if (from >= count || target >= count) return false;
+            return closure.test(from, target);
+        }
+
+        // Number of nodes `from` reaches, itself included: a popcount of its row.
+        DagIndexType reachableCount(DagIndexType from) const { return from < count ? closure.count(from) : 0; }
+
+        // True if adding from -> to would close a cycle (including a self loop).
+        bool createsCycle(DagIndexType from, DagIndexType to) const { return reachable(to, from); }
+
+        // False once a node indexed from `dag` was removed or its slot recycled, i.e. build() is due.
+        template<typename DAG>
+        bool isCurrent(const DAG& dag) const {
+            if (dag.size() < count) return false;
+            for (DagIndexType u = 0; u < generations.size(); u++) {
+                if (generationOf(dag, u) != generations[u]) return false;
+            }
+            return true;
+        }
+
+        // Mirrors DAG::addNode. Rows are re-laid out only when the word width has to grow (doubling).
+        DagIndexType addNode() {
+            if (count + 1 > closure.words * 64) {
+                detail::BitMatrix grown;
+                grown.words = std::max<size_t>(1, closure.words * 2);
+                grown.bits.assign((count + 1) * grown.words, 0);
+                for (DagIndexType u = 0; u < count; u++) std::copy_n(closure.row(u), closure.words, grown.row(u));
+                closure = std::move(grown);
+            }
+            else {
+                closure.bits.resize((count + 1) * closure.words, 0);
+            }
+            closure.set(count, count);
+            return count++;
+        }
+
+        // Mirrors DAG::addEdge for an edge known to keep the graph acyclic: every node reaching `from`
+        // now also reaches everything `to` reaches. O(nodeCount * nodeCount / 64) worst case.
+        void addEdge(DagIndexType from, DagIndexType to) {
+            if (from >= count || to >= count || reachable(from, to)) return;
+            for (DagIndexType u = 0; u < count; u++) {
+                if (closure.test(u, from)) closure.merge(u, to);
+            }
+        }
+
+        // dag.addEdge with the cycle check done on the index; endpoints recycled since they were
+        // indexed are rejected as Rejection::StaleHandle.
+        template<typename DAG>
+        auto addEdge(DAG& dag, DagIndexType from, DagIndexType to, DagEdgeFlags flags = 0) {
+            using Result = decltype(dag.addEdgeUnchecked(from, to, flags));
+            while (count < dag.size()) addNode();
+            recordGenerations(dag);
+            if (!dag.contains(from) || !dag.contains(to)) { dag.reject(Rejection::InvalidNode); return Result{}; }
+            if (generationOf(dag, from) != generations[from] || generationOf(dag, to) != generations[to]) {
+                dag.reject(Rejection::StaleHandle);
+                return Result{};
+            }
+            if (createsCycle(from, to)) { dag.reject(Rejection::Cycle); return Result{}; }
+
+            auto result = dag.addEdgeUnchecked(from, to, flags);
+            if (result) addEdge(from, to);
+            return result;
+        }
+
+    private:
+        detail::BitMatrix closure;
+        DagIndexType count = 0;
+        std::vector<uint32_t> generations; // per indexed node, 0 for graphs without handles
+
+        template<typename DAG>
+        static uint32_t generationOf(const DAG& dag, DagIndexType node) {
+            if constexpr (requires { dag.handle(node); }) return dag.handle(node).generation;
+            else return 0;
+        }
+
+        // Snapshots the generations of the nodes not recorded yet.
+        template<typename DAG>
+        void recordGenerations(const DAG& dag) {
+            for (DagIndexType u = generations.size(); u < count; u++) generations.push_back(generationOf(dag, u));
+        }
+    };
+
+    namespace detail
+    {
+        enum class Escape { Dot, Xml, Json };
+
+        // Output buffer for the exporters: text is gathered in 64 KiB chunks and handed to the stream
+        // one chunk at a time, and integers are formatted with to_chars instead of via std::string.
+        class ChunkedWriter {
+        public:
+            explicit ChunkedWriter(std::ostream& out) : out(out), buffer(capacity) {}
+            ~ChunkedWriter() { flush(); }
+
+            ChunkedWriter(const ChunkedWriter&) = delete;
+            ChunkedWriter& operator=(const ChunkedWriter&) = delete;
+
+            ChunkedWriter& operator<<(std::string_view text) {
+                if (text.size() > capacity - used) {
+                    flush();
+                    if (text.size() > capacity) {
+                        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                        return *this;
+                    }
+                }
+                std::memcpy(buffer.data() + used, text.data(), text.size());
+                used += text.size();
+                return *this;
+            }
+
+            ChunkedWriter& operator<<(char c) {
+                if (used == capacity) flush();
+                buffer[used++] = c;
+                return *this;
+            }
+
+            template<typename Number>
+                requires (std::is_arithmetic_v<Number> && !std::is_same_v<Number, char> && !std::is_same_v<Number, bool>)
+            ChunkedWriter& operator<<(Number value) {
+                char digits[64];
+                auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+                return *this << std::string_view(digits, end - digits);
+            }
+
+            // Writes `text` escaped for a quoted DOT string, XML attribute or JSON string.
+            void escaped(std::string_view text, Escape mode) {
+                for (char c : text) {
+                    switch (mode) {
+                    case Escape::Dot:
+                        if (c == '"' || c == '\\') *this << '\\' << c;
+                        else if (c == '\n') *this << "\\n";
+                        else *this << c;
+                        break;
+                    case Escape::Xml:
+                        if (c == '&') *this << "&amp;";
+                        else if (c == '<') *this << "&lt;";
+                        else if (c == '>') *this << "&gt;";
+                        else if (c == '"') *this << "&quot;";
+                        else *this << c;
+                        break;
+                    case Escape::Json:
+                        if (c == '"' || c == '\\') *this << '\\' << c;
+                        else if (c == '\n') *this << "\\n";
+                        else if (static_cast<unsigned char>(c) < 0x20) {
+                            static constexpr char hex[] = "0123456789abcdef";
+                            *this << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+                        }
+                        else *this << c;
+                        break;
+                    }
+                }
+            }
+
+            void flush() {
+                out.write(buffer.data(), static_cast<std::streamsize>(used));
+                used = 0;
+            }
+
+        private:
+            static constexpr size_t capacity = 64 * 1024;
+            std::ostream& out;
+            std::vector<char> buffer;
+            size_t used = 0;
+        };
+
+        // Writes the label of node i, computed once per node by the exporters: nodeLabel(i) if given,
+        // otherwise the node data when it is a number or a string, otherwise the index.
+        template<typename DAG>
+        void writeLabel(ChunkedWriter& w, const DAG& dag, DagIndexType i, const std::function<std::string(DagIndexType)>& nodeLabel, Escape mode) {
+            if (nodeLabel) {
+                w.escaped(nodeLabel(i), mode);
+            }
+            else if constexpr (requires { dag.nodes[i].data; }) {
+                using Data = std::remove_cvref_t<decltype(dag.nodes[i].data)>;
+                if constexpr (std::is_same_v<Data, bool>) w << (dag.nodes[i].data ? "true" : "false");
+                else if constexpr (std::is_same_v<Data, char>) w.escaped(std::string_view(&dag.nodes[i].data, 1), mode);
+                else if constexpr (std::is_arithmetic_v<Data>) w << dag.nodes[i].data;
+                else if constexpr (std::is_convertible_v<const Data&, std::string_view>) w.escaped(dag.nodes[i].data, mode);
+                else w << i;
+            }
+            else {
+                w << i;
+            }
+        }
+    } // namespace detail
+
+    // Writes the graph in Graphviz DOT, each live node declared once with its label (nodeLabel(i), or
+    // the node data / index).
+    template<typename DAG>
+    void exportToDot(
+        const DAG& dag,
+        std::ostream& output,
+        std::function<std::string(DagIndexType)> nodeLabel = nullptr,
+        std::function<bool(DagIndexType, DagIndexType)> edgeFilter = nullptr
+    ) {
+        detail::ChunkedWriter w(output);
+        w << "digraph DAG {\n";
+
+        for (DagIndexType i = 0; i < dag.size(); ++i) {
+            if (!detail::isLive(dag, i)) continue;
+            w << "    n" << i << " [label=\"";
+            detail::writeLabel(w, dag, i, nodeLabel, detail::Escape::Dot);
+            w << "\"];\n";
+        }
+
+        for (DagIndexType i = 0; i < dag.size(); ++i) {
+            dag.forEachEdge(i, [&](DagIndexType to, const auto&) {
+                if (!edgeFilter || edgeFilter(i, to)) {
+                    w << "    n" << i << " -> n" << to << ";\n";
+                }
+            });
+        }
+
+        w << "}\n";
+    }
+
+    // Same graph as exportToDot in GraphML, with the label as node data "label" and the edge flags
+    // as edge data "flags".
+    template<typename DAG>
+    void exportToGraphML(
+        const DAG& dag,
+        std::ostream& output,
+        std::function<std::string(DagIndexType)> nodeLabel = nullptr,
+        std::function<bool(DagIndexType, DagIndexType)> edgeFilter = nullptr
+    ) {
+        detail::ChunkedWriter w(output);
+        w << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+             "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+             "  <key id=\"label\" for=\"node\" attr.name=\"label\" attr.type=\"string\"/>\n"
+             "  <key id=\"flags\" for=\"edge\" attr.name=\"flags\" attr.type=\"long\"/>\n"
+             "  <graph id=\"DAG\" edgedefault=\"directed\">\n";
+
+        for (DagIndexType i = 0; i < dag.size(); ++i) {
+            if (!detail::isLive(dag, i)) continue;
+            w << "    <node id=\"n" << i << "\"><data key=\"label\">";
+            detail::writeLabel(w, dag, i, nodeLabel, detail::Escape::Xml);
+            w << "</data></node>\n";
+        }
+
+        for (DagIndexType i = 0; i < dag.size(); ++i) {
+            dag.forEachEdge(i, [&](DagIndexType to, const auto& edge) {
+                if (!edgeFilter || edgeFilter(i, to)) {
+                    w << "    <edge source=\"n" << i << "\" target=\"n" << to << "\"><data key=\"flags\">"
+                      << detail::edgeFlags(edge) << "</data></edge>\n";
+                }
+            });
+        }
+
+        w << "  </graph>\n</graphml>\n";
+    }
+
+    // Node list plus edge list as JSON:
+    // {"nodes":[{"id":0,"label":"..."},...],"edges":[{"source":0,"target":1,"flags":0},...]}
+    template<typename DAG>
+    void exportToJson(
+        const DAG& dag,
+        std::ostream& output,
+        std::function<std::string(DagIndexType)> nodeLabel = nullptr,
+        std::function<bool(DagIndexType, DagIndexType)> edgeFilter = nullptr
+    ) {
+        detail::ChunkedWriter w(output);
+        w << "{\"nodes\":[";
+
+        bool first = true;
+        for (DagIndexType i = 0; i < dag.size(); ++i) {
+            if (!detail::isLive(dag, i)) continue;
+            if (!first) w << ',';
+            first = false;
+            w << "\n{\"id\":" << i << ",\"label\":\"";
+            detail::writeLabel(w, dag, i, nodeLabel, detail::Escape::Json);
+            w << "\"}";
+        }
+
+        w << "],\"edges\":[";
+        first = true;
+        for (DagIndexType i = 0; i < dag.size(); ++i) {
+            dag.forEachEdge(i, [&](DagIndexType to, const auto& edge) {
+                if (!edgeFilter || edgeFilter(i, to)) {
+                    if (!first) w << ',';
+                    first = false;
+                    w << "\n{\"source\":" << i << ",\"target\":" << to << ",\"flags\":" << detail::edgeFlags(edge) << '}';
+                }
+            });
+        }
+
+        w << "]}\n";
+    }
 
-} // namespace dag
\ No newline at end of file
+} // namespace dag
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "dag.hpp"
+
+namespace dag
+{
+
+    // Work-stealing pool running a task per node once all of its predecessors finished. The DAG must
+    // not change during a run and tasks must not call run(); concurrent run() calls are serialized.
+    class Executor {
+    public:
+        explicit Executor(unsigned threads = std::thread::hardware_concurrency())
+            : queues(threads == 0 ? 1 : threads)
+        {
+            workers.reserve(queues.size());
+            for (unsigned id = 0; id < queues.size(); id++) {
+                workers.emplace_back([this, id] { workerLoop(id); });
+            }
+        }
+
+        ~Executor() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& worker : workers) worker.join();
+        }
+
+        Executor(const Executor&) = delete;
+        Executor& operator=(const Executor&) = delete;
+
+        unsigned threadCount() const { return static_cast<unsigned>(queues.size()); }
+
+        // Calls fn(node) once per node in dependency order and blocks until done. The first exception
+        // a task throws stops new tasks and is rethrown once the running ones finished.
+        template<typename DAG, typename Fn, typename Filter = NoFilter>
+        void run(const DAG& dag, Fn&& fn, Filter&& edgeFilter = {}) {
+            std::lock_guard<std::mutex> runLock(runMutex);
+
+            const DagIndexType n = dag.size();
+            if (n == 0) return;
+
+            auto indegree = std::make_unique<std::atomic<DagIndexType>[]>(n);
+            for (DagIndexType u = 0; u < n; u++) {
+                dag.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (detail::passes(edgeFilter, u, to, edge)) indegree[to].fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+
+            failure = nullptr;
+            cancelled.store(false, std::memory_order_relaxed);
+            task = [&](DagIndexType u, unsigned worker) {
+                if (cancelled.load(std::memory_order_relaxed)) return;
+                try {
+                    fn(u);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!failure) failure = std::current_exception();
+                    cancelled.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                dag.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (detail::passes(edgeFilter, u, to, edge) && indegree[to].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        push(worker, to);
+                    }
+                });
+            };
+
+            // Collect the roots before seeding them round-robin: once the first one is pushed, workers
+            // start driving other counters to zero concurrently.
+            std::vector<DagIndexType> roots;
+            for (DagIndexType u = 0; u < n; u++) {
+                if (indegree[u].load(std::memory_order_relaxed) == 0 && detail::isLive(dag, u)) roots.push_back(u);
+            }
+            for (size_t i = 0; i < roots.size(); i++) push(static_cast<unsigned>(i % threadCount()), roots[i]);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&] { return outstanding.load(std::memory_order_acquire) == 0; });
+            task = nullptr;
+            if (failure) std::rethrow_exception(std::exchange(failure, nullptr));
+        }
+
+    private:
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<DagIndexType> tasks;
+        };
+
+        std::vector<WorkQueue> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;               // guards sleeping/waking, `failure` and `stopping`
+        std::condition_variable wake;   // workers wait here for queued tasks
+        std::condition_variable done;   // run() waits here for `outstanding` to drain
+        std::mutex runMutex;
+
+        std::function<void(DagIndexType, unsigned)> task;
+        std::atomic<size_t> pending{ 0 };     // queued, not yet taken
+        std::atomic<size_t> outstanding{ 0 }; // queued or running
+        std::atomic<bool> cancelled{ false };
+        std::exception_ptr failure;
+        bool stopping = false;
+
+        void push(unsigned worker, DagIndexType node) {
+            outstanding.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> lock(queues[worker].mutex);
+                queues[worker].tasks.push_back(node);
+            }
+            pending.fetch_add(1, std::memory_order_release);
+            { std::lock_guard<std::mutex> lock(mutex); }
+            wake.notify_one();
+        }
+
+        bool pop(unsigned worker, DagIndexType& node) {
+            {
+                auto& own = queues[worker];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.tasks.empty()) {
+                    node = own.tasks.back();
+                    own.tasks.pop_back();
+                    return true;
+                }
+            }
+            for (unsigned i = 1; i < queues.size(); i++) {
+                auto& victim = queues[(worker + i) % queues.size()];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty()) {
+                    node = victim.tasks.front();
+                    victim.tasks.pop_front();
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void workerLoop(unsigned id) {
+            for (;;) {
+                DagIndexType node;
+                if (pop(id, node)) {
+                    pending.fetch_sub(1, std::memory_order_relaxed);
+                    task(node, id);
+                    if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        { std::lock_guard<std::mutex> lock(mutex); }
+                        done.notify_all();
+                    }
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || pending.load(std::memory_order_acquire) > 0; });
+                if (stopping && pending.load(std::memory_order_acquire) == 0) return;
+            }
+        }
+    };
+
+    // One-shot convenience: runs fn(node) over `dag` on a temporary pool of `threads` workers
+    // (0 = hardware concurrency).
+    template<typename DAG, typename Fn, typename Filter = NoFilter>
+    void run(const DAG& dag, Fn&& fn, unsigned threads = 0, Filter&& edgeFilter = {}) {
+        Executor executor(threads == 0 ? std::thread::hardware_concurrency() : threads);
+        executor.run(dag, std::forward<Fn>(fn), std::forward<Filter>(edgeFilter));
+    }
+
+} // namespace dag
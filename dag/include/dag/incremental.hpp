@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+
+#include "dag.hpp"
+
+namespace dag
+{
+
+    // Memoized recomputation over the values in Node::data: recompute() revisits only what the dirty
+    // nodes invalidate. The DAG may change between ticks, not during recompute().
+    template<typename DAG>
+    class Incremental {
+    public:
+        explicit Incremental(DAG& dag) : graph(&dag) {}
+
+        DAG& dag() const { return *graph; }
+
+        // Schedules `node` for the next recompute(). Returns false if it is not a live node.
+        bool markDirty(DagIndexType node) {
+            if (node >= graph->size() || !detail::isLive(*graph, node)) return false;
+            if (stale.size() < graph->size()) stale.resize(graph->size());
+            if (stale.insert(node)) dirty.push_back(node);
+            return true;
+        }
+
+        void markAllDirty() {
+            for (DagIndexType u = 0; u < graph->size(); u++) markDirty(u);
+        }
+
+        bool isDirty(DagIndexType node) const { return node < stale.size() && stale.test(node); }
+        DagIndexType dirtyCount() const { return dirty.size(); }
+
+        // Nodes fn was called on by the last recompute(), in the order it ran them.
+        const std::vector<DagIndexType>& recomputed() const { return ran; }
+
+        // Calls fn(node, value) on the dirty nodes and the successors of changed ones, in order; returns
+        // the call count. If fn throws, the unfinished nodes stay dirty.
+        template<typename Fn, typename Filter = NoFilter>
+        DagIndexType recompute(Fn&& fn, Filter&& edgeFilter = {}) {
+            const DagIndexType n = graph->size();
+            ran.clear();
+            if (dirty.empty()) return 0;
+            stale.resize(n);
+            if (ws.indegree.size() < n) ws.indegree.resize(n);
+
+            // Everything a dirty node reaches may have to run again.
+            ws.beginVisit(n);
+            ws.stack.clear();
+            affected.clear();
+            for (auto u : dirty) {
+                if (!detail::isLive(*graph, u)) { stale.reset(u); continue; }
+                if (ws.visit(u)) ws.stack.push_back(u);
+            }
+            dirty.clear();
+            while (!ws.stack.empty()) {
+                const DagIndexType u = ws.stack.back();
+                ws.stack.pop_back();
+                affected.push_back(u);
+                ws.indegree[u] = 0;
+                graph->forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (detail::passes(edgeFilter, u, to, edge) && ws.visit(to)) ws.stack.push_back(to);
+                });
+            }
+
+            // Edges into the affected set from outside come from up-to-date nodes, so only edges
+            // within it constrain the order.
+            for (auto u : affected) {
+                graph->forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (detail::passes(edgeFilter, u, to, edge)) ws.indegree[to]++;
+                });
+            }
+
+            ws.order.clear();
+            for (auto u : affected) if (ws.indegree[u] == 0) ws.order.push_back(u);
+
+            try {
+                for (DagIndexType head = 0; head < ws.order.size(); head++) {
+                    const DagIndexType u = ws.order[head];
+                    bool changed = false;
+                    if (stale.test(u)) {
+                        changed = static_cast<bool>(fn(u, graph->nodes[u].data));
+                        stale.reset(u);
+                        ran.push_back(u);
+                    }
+                    graph->forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                        if (!detail::passes(edgeFilter, u, to, edge)) return;
+                        if (changed) stale.set(to);
+                        if (--ws.indegree[to] == 0) ws.order.push_back(to);
+                    });
+                }
+            }
+            catch (...) {
+                for (auto u : affected) if (stale.test(u)) dirty.push_back(u);
+                throw;
+            }
+            return ran.size();
+        }
+
+    private:
+        DAG* graph;
+        std::vector<DagIndexType> dirty;    // marked since the last recompute(), each once
+        DenseBitset stale;                  // per node: dirty, or an input changed during this tick
+        std::vector<DagIndexType> affected;
+        std::vector<DagIndexType> ran;
+        Workspace ws;
+    };
+
+} // namespace dag
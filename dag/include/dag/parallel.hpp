@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <exception>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "dag.hpp"
+
+namespace dag
+{
+
+    namespace detail
+    {
+        // Below this many nodes per thread, spawning threads costs more than it saves.
+        inline constexpr DagIndexType parallelGrain = 4096;
+
+        // Level-synchronous Kahn's algorithm on `threads` threads, the caller included. edgeFilter runs
+        // concurrently; its first exception stops the run and is rethrown here.
+        template<typename Graph, typename Filter>
+        void parallelTopologicalLevels(const Graph& g, Filter& edgeFilter, unsigned threads, bool deterministic, TopologicalLevels& levels) {
+            const DagIndexType n = g.size();
+            levels.nodes.clear();
+            levels.nodes.reserve(n);
+            levels.offsets.assign(1, 0);
+
+            auto indegree = std::make_unique<std::atomic<DagIndexType>[]>(n);
+            std::vector<std::vector<DagIndexType>> found(threads);
+            std::atomic<DagIndexType> cursor{ 0 };
+            DagIndexType begin = 0, end = n; // the range the current phase works on
+            bool counting = true, done = false;
+            std::atomic<bool> failed{ false };
+            std::exception_ptr failure; // written once, by the thread that set `failed`
+
+            // Runs on one thread once all threads reached the barrier.
+            auto merge = [&]() noexcept {
+                cursor.store(0, std::memory_order_relaxed);
+                if (failed.load(std::memory_order_relaxed)) { done = true; return; }
+                if (counting) { counting = false; return; } // next phase: collect roots over [0, n)
+
+                const DagIndexType first = levels.nodes.size();
+                for (auto& buffer : found) {
+                    levels.nodes.insert(levels.nodes.end(), buffer.begin(), buffer.end());
+                    buffer.clear();
+                }
+                if (levels.nodes.size() == first) { done = true; return; }
+                if (deterministic) std::sort(levels.nodes.begin() + first, levels.nodes.end());
+                levels.offsets.push_back(levels.nodes.size());
+                begin = first;
+                end = levels.nodes.size();
+            };
+            std::barrier sync(static_cast<std::ptrdiff_t>(threads), merge);
+
+            // Hands out [begin, end) in chunks; small enough to balance skewed degrees.
+            auto forChunks = [&](auto&& fn) {
+                const DagIndexType grain = std::clamp<DagIndexType>((end - begin) / (threads * 8), 64, parallelGrain);
+                while (!failed.load(std::memory_order_relaxed)) {
+                    const DagIndexType k = begin + cursor.fetch_add(grain, std::memory_order_relaxed);
+                    if (k >= end) return;
+                    const DagIndexType stop = std::min(end, k + grain);
+                    for (DagIndexType i = k; i < stop; i++) fn(i);
+                }
+            };
+
+            auto phases = [&](unsigned t) {
+                forChunks([&](DagIndexType u) {
+                    g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                        if (passes(edgeFilter, u, to, edge)) indegree[to].fetch_add(1, std::memory_order_relaxed);
+                    });
+                });
+                sync.arrive_and_wait();
+
+                forChunks([&](DagIndexType u) {
+                    if (indegree[u].load(std::memory_order_relaxed) == 0 && isLive(g, u)) found[t].push_back(u);
+                });
+                sync.arrive_and_wait();
+
+                while (!done) {
+                    forChunks([&](DagIndexType k) {
+                        const DagIndexType u = levels.nodes[k];
+                        g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                            if (passes(edgeFilter, u, to, edge) && indegree[to].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                                found[t].push_back(to);
+                            }
+                        });
+                    });
+                    sync.arrive_and_wait();
+                }
+            };
+
+            // A thread that fails leaves the barrier, so the others finish the phase without it.
+            auto work = [&](unsigned t) {
+                try {
+                    phases(t);
+                }
+                catch (...) {
+                    if (!failed.exchange(true)) failure = std::current_exception();
+                    sync.arrive_and_drop();
+                }
+            };
+
+            {
+                std::vector<std::jthread> pool;
+                pool.reserve(threads - 1);
+                unsigned started = 1;
+                try {
+                    for (; started < threads; started++) pool.emplace_back(work, started);
+                }
+                catch (const std::system_error&) {
+                    // Chunks are claimed dynamically: the threads that did start do the work alone.
+                    for (unsigned t = started; t < threads; t++) sync.arrive_and_drop();
+                }
+                work(0);
+            }
+            if (failure) std::rethrow_exception(failure);
+        }
+
+        template<typename Graph, typename Filter>
+        TopologicalLevels parallelTopologicalLevels(const Graph& g, Filter& edgeFilter, unsigned threads, bool deterministic) {
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            threads = static_cast<unsigned>(std::min<DagIndexType>(threads, std::max<DagIndexType>(1, g.size() / parallelGrain)));
+
+            TopologicalLevels levels;
+            if (threads == 1) {
+                levels = topologicalLevels(g, edgeFilter);
+                if (deterministic) {
+                    for (DagIndexType i = 0; i < levels.levelCount(); i++) {
+                        std::sort(levels.nodes.begin() + levels.offsets[i], levels.nodes.begin() + levels.offsets[i + 1]);
+                    }
+                }
+                return levels;
+            }
+            parallelTopologicalLevels(g, edgeFilter, threads, deterministic, levels);
+            return levels;
+        }
+    } // namespace detail
+
+    // topologicalLevels of any DAG on `threads` threads (0 = hardware concurrency); small graphs run
+    // serially. `deterministic` sorts each level by index.
+    template<typename DAG, typename Filter = NoFilter>
+    TopologicalLevels parallelTopologicalLevels(const DAG& dag, unsigned threads = 0, bool deterministic = false, Filter&& edgeFilter = {}) {
+        return detail::parallelTopologicalLevels(dag, edgeFilter, threads, deterministic);
+    }
+
+    // The same as a flat order: levels one after another, a valid topological order.
+    template<typename DAG, typename Filter = NoFilter>
+    std::vector<DagIndexType> parallelTopologicalSort(const DAG& dag, unsigned threads = 0, bool deterministic = false, Filter&& edgeFilter = {}) {
+        return std::move(detail::parallelTopologicalLevels(dag, edgeFilter, threads, deterministic).nodes);
+    }
+
+} // namespace dag
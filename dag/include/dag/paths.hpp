@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "dag.hpp"
+
+namespace dag
+{
+
+    // Cost function meaning "costs nothing", the default node and edge cost of the path queries. Like
+    // NoFilter it is recognised at compile time and adds no call per node or edge.
+    struct NoCost {};
+
+    // Best paths from a set of sources: distance[v] counts every node (both ends) and edge on the path,
+    // parent[v] is npos at the sources. Only nodes in `reached` have a path.
+    template<typename Weight>
+    struct Paths {
+        static constexpr DagIndexType npos = -1;
+
+        std::vector<Weight> distance;
+        std::vector<DagIndexType> parent;
+        DenseBitset reached;
+
+        // The nodes of the path ending at `node`, source first; empty if it is not reached.
+        std::vector<DagIndexType> pathTo(DagIndexType node) const {
+            std::vector<DagIndexType> path;
+            if (node >= reached.size() || !reached.test(node)) return path;
+            for (DagIndexType v = node; v != npos; v = parent[v]) path.push_back(v);
+            std::reverse(path.begin(), path.end());
+            return path;
+        }
+    };
+
+    // Critical-path schedule: earliest and latest starts, total length and one zero-slack chain.
+    // Removed DynamicDAG slots are left at 0.
+    template<typename Weight>
+    struct CriticalPath {
+        std::vector<Weight> earliestStart;
+        std::vector<Weight> latestStart;
+        std::vector<DagIndexType> path;
+        Weight length{};
+
+        Weight slack(DagIndexType node) const { return latestStart[node] - earliestStart[node]; }
+    };
+
+    namespace detail
+    {
+        // The type forEachEdge passes as the edge argument: a StaticDAG Edge, the flags otherwise.
+        template<typename Graph>
+        struct EdgeArgOf { using type = DagEdgeFlags; };
+
+        template<typename Graph>
+            requires requires { typename Graph::Edge; }
+        struct EdgeArgOf<Graph> { using type = typename Graph::Edge; };
+
+        template<typename Cost, typename... Args>
+        struct CostOf { using type = std::remove_cvref_t<std::invoke_result_t<Cost&, Args...>>; };
+
+        template<typename... Args>
+        struct CostOf<NoCost, Args...> { using type = void; };
+
+        template<typename A, typename B>
+        struct CommonCost : std::common_type<A, B> {};
+        template<typename B>
+        struct CommonCost<void, B> { using type = B; };
+        template<typename A>
+        struct CommonCost<A, void> { using type = A; };
+        template<>
+        struct CommonCost<void, void> { using type = DagIndexType; };
+
+        // Weight type of a path query: what the node and edge costs return, in common.
+        template<typename Graph, typename NodeCost, typename EdgeCost>
+        using PathWeight = typename CommonCost<
+            typename CostOf<std::remove_cvref_t<NodeCost>, DagIndexType>::type,
+            typename CostOf<std::remove_cvref_t<EdgeCost>, DagIndexType, DagIndexType, const typename EdgeArgOf<Graph>::type&>::type>::type;
+
+        template<typename Weight, typename Cost>
+        Weight nodeCost(Cost& cost, DagIndexType node) {
+            if constexpr (std::is_same_v<std::remove_cvref_t<Cost>, NoCost>) return Weight{};
+            else return static_cast<Weight>(cost(node));
+        }
+
+        template<typename Weight, typename Cost, typename EdgeArg>
+        Weight edgeCost(Cost& cost, DagIndexType from, DagIndexType to, const EdgeArg& edge) {
+            if constexpr (std::is_same_v<std::remove_cvref_t<Cost>, NoCost>) return Weight{};
+            else return static_cast<Weight>(cost(from, to, edge));
+        }
+
+        // Relaxes every edge once, in topological order, keeping for each node the path `better` prefers.
+        template<typename Better, typename Graph, typename Weight, typename NodeCost, typename EdgeCost, typename Filter>
+        void bestPaths(const Graph& g, std::span<const DagIndexType> sources, Paths<Weight>& out, Workspace& ws, NodeCost& nodeCost, EdgeCost& edgeCost, Filter& edgeFilter) {
+            const DagIndexType n = g.size();
+            topologicalSort(g, edgeFilter, ws.indegree, ws.order);
+            out.distance.assign(n, Weight{});
+            out.parent.assign(n, Paths<Weight>::npos);
+            out.reached.assign(n);
+            for (auto source : sources) {
+                if (source < n && isLive(g, source) && out.reached.insert(source)) out.distance[source] = detail::nodeCost<Weight>(nodeCost, source);
+            }
+
+            Better better;
+            for (auto u : ws.order) {
+                if (!out.reached.test(u)) continue;
+                g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (!passes(edgeFilter, u, to, edge)) return;
+                    const Weight d = out.distance[u] + detail::edgeCost<Weight>(edgeCost, u, to, edge) + detail::nodeCost<Weight>(nodeCost, to);
+                    if (out.reached.insert(to) || better(d, out.distance[to])) {
+                        out.distance[to] = d;
+                        out.parent[to] = u;
+                    }
+                });
+            }
+        }
+
+        // Forward pass for earliest starts, backward pass for latest starts, both over one
+        // topological order. ws.indegree, all zero once Kahn's algorithm is done, holds the parents.
+        template<typename Graph, typename Weight, typename NodeCost, typename EdgeCost, typename Filter>
+        void criticalPath(const Graph& g, CriticalPath<Weight>& out, Workspace& ws, NodeCost& nodeCost, EdgeCost& edgeCost, Filter& edgeFilter) {
+            constexpr DagIndexType npos = -1;
+            const DagIndexType n = g.size();
+            topologicalSort(g, edgeFilter, ws.indegree, ws.order);
+            out.earliestStart.assign(n, Weight{});
+            out.latestStart.assign(n, Weight{});
+            out.path.clear();
+            out.length = Weight{};
+
+            auto& parent = ws.indegree;
+            parent.assign(n, npos);
+            DagIndexType last = npos;
+            for (auto u : ws.order) {
+                const Weight finish = out.earliestStart[u] + detail::nodeCost<Weight>(nodeCost, u);
+                if (last == npos || finish > out.length) { out.length = finish; last = u; }
+                g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (!passes(edgeFilter, u, to, edge)) return;
+                    const Weight start = finish + detail::edgeCost<Weight>(edgeCost, u, to, edge);
+                    if (parent[to] == npos || start > out.earliestStart[to]) {
+                        out.earliestStart[to] = start;
+                        parent[to] = u;
+                    }
+                });
+            }
+
+            for (auto it = ws.order.rbegin(); it != ws.order.rend(); ++it) {
+                const DagIndexType u = *it;
+                Weight latestFinish = out.length;
+                g.forEachEdge(u, [&](DagIndexType to, const auto& edge) {
+                    if (!passes(edgeFilter, u, to, edge)) return;
+                    latestFinish = std::min<Weight>(latestFinish, out.latestStart[to] - detail::edgeCost<Weight>(edgeCost, u, to, edge));
+                });
+                out.latestStart[u] = latestFinish - detail::nodeCost<Weight>(nodeCost, u);
+            }
+
+            for (DagIndexType v = last; v != npos; v = parent[v]) out.path.push_back(v);
+            std::reverse(out.path.begin(), out.path.end());
+        }
+    } // namespace detail
+
+    // Single-pass path queries over a topological order, O(V + E). Only edges passing `edgeFilter`
+    // are paths.
+
+    // Heaviest path from any of `sources` to every node.
+    template<typename DAG, typename NodeCost = NoCost, typename EdgeCost = NoCost, typename Filter = NoFilter>
+    auto longestPaths(const DAG& dag, std::span<const DagIndexType> sources, NodeCost&& nodeCost = {}, EdgeCost&& edgeCost = {}, Filter&& edgeFilter = {}) {
+        Paths<detail::PathWeight<DAG, NodeCost, EdgeCost>> out;
+        Workspace ws;
+        detail::bestPaths<std::greater<>>(dag, sources, out, ws, nodeCost, edgeCost, edgeFilter);
+        return out;
+    }
+
+    template<typename DAG, typename Weight, typename NodeCost = NoCost, typename EdgeCost = NoCost, typename Filter = NoFilter>
+    void longestPaths(const DAG& dag, std::span<const DagIndexType> sources, Paths<Weight>& out, Workspace& ws, NodeCost&& nodeCost = {}, EdgeCost&& edgeCost = {}, Filter&& edgeFilter = {}) {
+        detail::bestPaths<std::greater<>>(dag, sources, out, ws, nodeCost, edgeCost, edgeFilter);
+    }
+
+    // Lightest path from any of `sources` to every node. Negative costs are fine: there are no cycles.
+    template<typename DAG, typename NodeCost = NoCost, typename EdgeCost = NoCost, typename Filter = NoFilter>
+    auto shortestPaths(const DAG& dag, std::span<const DagIndexType> sources, NodeCost&& nodeCost = {}, EdgeCost&& edgeCost = {}, Filter&& edgeFilter = {}) {
+        Paths<detail::PathWeight<DAG, NodeCost, EdgeCost>> out;
+        Workspace ws;
+        detail::bestPaths<std::less<>>(dag, sources, out, ws, nodeCost, edgeCost, edgeFilter);
+        return out;
+    }
+
+    template<typename DAG, typename Weight, typename NodeCost = NoCost, typename EdgeCost = NoCost, typename Filter = NoFilter>
+    void shortestPaths(const DAG& dag, std::span<const DagIndexType> sources, Paths<Weight>& out, Workspace& ws, NodeCost&& nodeCost = {}, EdgeCost&& edgeCost = {}, Filter&& edgeFilter = {}) {
+        detail::bestPaths<std::less<>>(dag, sources, out, ws, nodeCost, edgeCost, edgeFilter);
+    }
+
+    // Earliest and latest starts, slack and one critical path of the whole graph (see CriticalPath).
+    template<typename DAG, typename NodeCost = NoCost, typename EdgeCost = NoCost, typename Filter = NoFilter>
+    auto criticalPath(const DAG& dag, NodeCost&& nodeCost = {}, EdgeCost&& edgeCost = {}, Filter&& edgeFilter = {}) {
+        CriticalPath<detail::PathWeight<DAG, NodeCost, EdgeCost>> out;
+        Workspace ws;
+        detail::criticalPath(dag, out, ws, nodeCost, edgeCost, edgeFilter);
+        return out;
+    }
+
+    template<typename DAG, typename Weight, typename NodeCost = NoCost, typename EdgeCost = NoCost, typename Filter = NoFilter>
+    void criticalPath(const DAG& dag, CriticalPath<Weight>& out, Workspace& ws, NodeCost&& nodeCost = {}, EdgeCost&& edgeCost = {}, Filter&& edgeFilter = {}) {
+        detail::criticalPath(dag, out, ws, nodeCost, edgeCost, edgeFilter);
+    }
+
+} // namespace dag
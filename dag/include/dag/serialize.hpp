@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "dag.hpp"
+
+namespace dag
+{
+
+    // File header, followed by offsets, targets, flags and node data, each padded to 8 bytes. Files
+    // are native-endian; mismatching byte order or element sizes are rejected.
+    struct FileHeader {
+        char magic[8];
+        uint32_t byteOrder;
+        uint32_t version;
+        uint32_t indexSize;
+        uint32_t flagsSize;
+        uint32_t dataSize;
+        uint32_t reserved;
+        uint64_t nodeCount;
+        uint64_t edgeCount;
+    };
+
+    static_assert(sizeof(FileHeader) == 48, "FileHeader must have no padding");
+
+    namespace detail
+    {
+        inline constexpr char fileMagic[8] = { 'D', 'A', 'G', 'C', 'S', 'R', '\0', '\0' };
+        inline constexpr uint32_t fileByteOrder = 0x01020304;
+        inline constexpr uint32_t fileVersion = 1;
+
+        constexpr uint64_t padded(uint64_t bytes) { return (bytes + 7) & ~uint64_t(7); }
+
+        template<typename T>
+        constexpr uint32_t dataSize() {
+            if constexpr (std::is_void_v<T>) return 0;
+            else return sizeof(T);
+        }
+
+        template<typename T>
+        constexpr bool mappable() {
+            if constexpr (std::is_void_v<T>) return true;
+            else return std::is_trivially_copyable_v<T> && alignof(T) <= 8;
+        }
+
+        // Byte offsets of the sections after the header, and the total file size. `valid` is false
+        // when the counts do not fit DagIndexType or the sizes overflow, whatever the offsets say.
+        struct FileLayout {
+            uint64_t offsets = 0, targets = 0, flags = 0, data = 0, end = 0;
+            bool valid = false;
+
+            constexpr FileLayout(const FileHeader& header) {
+                constexpr uint64_t maxIndex = static_cast<DagIndexType>(-1);
+                if (header.nodeCount >= maxIndex || header.edgeCount > maxIndex) return;
+                uint64_t at = sizeof(FileHeader);
+                offsets = at;
+                if (!advance(at, header.nodeCount + 1, header.indexSize)) return;
+                targets = at;
+                if (!advance(at, header.edgeCount, header.indexSize)) return;
+                flags = at;
+                if (!advance(at, header.edgeCount, header.flagsSize)) return;
+                data = at;
+                if (!advance(at, header.nodeCount, header.dataSize)) return;
+                end = at;
+                valid = true;
+            }
+
+        private:
+            // Moves `at` past a section of `count` elements of `size` bytes, false on overflow.
+            static constexpr bool advance(uint64_t& at, uint64_t count, uint64_t size) {
+                if (size != 0 && count > (UINT64_MAX - 7) / size) return false;
+                const uint64_t bytes = padded(count * size);
+                if (bytes > UINT64_MAX - at) return false;
+                at += bytes;
+                return true;
+            }
+        };
+
+        template<typename T>
+        FileHeader makeHeader(uint64_t nodeCount, uint64_t edgeCount) {
+            FileHeader header{};
+            std::memcpy(header.magic, fileMagic, sizeof(fileMagic));
+            header.byteOrder = fileByteOrder;
+            header.version = fileVersion;
+            header.indexSize = sizeof(DagIndexType);
+            header.flagsSize = sizeof(DagEdgeFlags);
+            header.dataSize = dataSize<T>();
+            header.nodeCount = nodeCount;
+            header.edgeCount = edgeCount;
+            return header;
+        }
+
+        // Null if `header` describes a file this build can read as element type T.
+        template<typename T>
+        const char* checkHeader(const FileHeader& header) {
+            static_assert(mappable<T>(), "node data must be trivially copyable and at most 8-byte aligned");
+            if (std::memcmp(header.magic, fileMagic, sizeof(fileMagic)) != 0) return "Not a DAG file";
+            if (header.byteOrder != fileByteOrder) return "Byte order mismatch";
+            if (header.version != fileVersion) return "Unsupported file version";
+            if (header.indexSize != sizeof(DagIndexType) || header.flagsSize != sizeof(DagEdgeFlags)) return "Index or flags type mismatch";
+            if (header.dataSize != dataSize<T>()) return "Node data type mismatch";
+            if (!FileLayout(header).valid) return "Corrupt header";
+            return nullptr;
+        }
+
+        inline void writeSection(std::ostream& out, const void* bytes, uint64_t size) {
+            static constexpr char zeros[8] = {};
+            out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+            out.write(zeros, static_cast<std::streamsize>(padded(size) - size));
+        }
+
+        // Reads a section of `count` elements into `v`, growing it a chunk at a time: a count larger
+        // than what the stream holds ends in a failed read, not in an allocation of that size.
+        template<typename Vector>
+        bool readSection(std::istream& in, Vector& v, uint64_t count) {
+            using Value = typename Vector::value_type;
+            constexpr uint64_t chunk = (uint64_t(1) << 20) / sizeof(Value);
+            v.clear();
+            while (v.size() < count) {
+                const size_t at = v.size();
+                v.resize(at + static_cast<size_t>(std::min<uint64_t>(chunk, count - at)));
+                if (!in.read(reinterpret_cast<char*>(v.data() + at), static_cast<std::streamsize>((v.size() - at) * sizeof(Value)))) return false;
+            }
+            char pad[8];
+            const uint64_t size = count * sizeof(Value);
+            in.read(pad, static_cast<std::streamsize>(padded(size) - size));
+            return static_cast<bool>(in);
+        }
+    } // namespace detail
+
+    // Writes `dag` in the binary CSR format, freezing StaticDAG/DynamicDAG first. False if the stream
+    // failed.
+    template<typename DAG>
+    bool save(const DAG& dag, std::ostream& out) {
+        using T = typename DAG::data_type;
+        static_assert(std::is_void_v<T> || std::is_trivially_copyable_v<T>, "node data must be trivially copyable to be saved");
+
+        if constexpr (!requires { dag.offsets; dag.targets; dag.flags; }) {
+            return save(freeze(dag), out);
+        }
+        else {
+            const auto header = detail::makeHeader<T>(dag.nodeCount(), dag.edgeCount());
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            detail::writeSection(out, dag.offsets.data(), dag.offsets.size() * sizeof(DagIndexType));
+            detail::writeSection(out, dag.targets.data(), dag.targets.size() * sizeof(DagIndexType));
+            detail::writeSection(out, dag.flags.data(), dag.flags.size() * sizeof(DagEdgeFlags));
+            if constexpr (!std::is_void_v<T>) {
+                for (DagIndexType i = 0; i < dag.nodeCount(); i++) {
+                    const T* data;
+                    if constexpr (requires { dag.nodes; }) data = &dag.nodes[i].data;
+                    else data = &dag.data(i);
+                    out.write(reinterpret_cast<const char*>(data), sizeof(T));
+                }
+                static constexpr char zeros[8] = {};
+                const uint64_t size = uint64_t(dag.nodeCount()) * sizeof(T);
+                out.write(zeros, static_cast<std::streamsize>(detail::padded(size) - size));
+            }
+            return static_cast<bool>(out);
+        }
+    }
+
+    // Reads and fully validates a file written by save(). On failure returns false, sets `error` if
+    // given and leaves `csr` empty.
+    template<typename T>
+    bool load(std::istream& in, CsrDAG<T>& csr, const char** error = nullptr) {
+        static_assert(std::is_void_v<T> || std::is_trivially_copyable_v<T>, "node data must be trivially copyable to be loaded");
+        auto fail = [&](const char* message) {
+            csr = {};
+            if (error) *error = message;
+            return false;
+        };
+
+        FileHeader header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return fail("Truncated file");
+        if (auto message = detail::checkHeader<T>(header)) return fail(message);
+
+        csr.inOffsets.clear();
+        csr.sources.clear();
+        csr.inFlags.clear();
+        if (!detail::readSection(in, csr.offsets, header.nodeCount + 1)
+            || !detail::readSection(in, csr.targets, header.edgeCount)
+            || !detail::readSection(in, csr.flags, header.edgeCount)) {
+            return fail("Truncated file");
+        }
+
+        if (csr.offsets.front() != 0 || csr.offsets.back() != header.edgeCount) return fail("Corrupt offsets");
+        for (DagIndexType i = 0; i < header.nodeCount; i++) {
+            if (csr.offsets[i] > csr.offsets[i + 1]) return fail("Corrupt offsets");
+        }
+        for (auto to : csr.targets) {
+            if (to >= header.nodeCount) return fail("Corrupt targets");
+        }
+
+        if constexpr (!std::is_void_v<T>) {
+            csr.nodes.clear();
+            while (csr.nodes.size() < header.nodeCount) {
+                if (!in.read(reinterpret_cast<char*>(&csr.nodes.emplace_back().data), sizeof(T))) return fail("Truncated file");
+            }
+            char pad[8];
+            const uint64_t size = header.nodeCount * sizeof(T);
+            in.read(pad, static_cast<std::streamsize>(detail::padded(size) - size));
+        }
+        return true;
+    }
+
+    // Read-only CSR graph over a memory-mapped file written by save(). Only the header and file size
+    // are checked, so use load() for untrusted input.
+    template<typename T = void>
+    class MappedDAG {
+        static_assert(detail::mappable<T>(), "mapped node data must be trivially copyable and at most 8-byte aligned");
+
+    public:
+        using data_type = T;
+
+        static constexpr DagIndexType npos = -1;
+
+        // Any callable with this signature can be passed as an edge filter (see StaticDAG::ReachableFn).
+        using ReachableFn = std::function<bool(DagIndexType from, DagIndexType to, DagEdgeFlags flags)>;
+
+        std::span<const DagIndexType> offsets;
+        std::span<const DagIndexType> targets;
+        std::span<const DagEdgeFlags> flags;
+        const char* lastError = nullptr;
+
+        MappedDAG() = default;
+        explicit MappedDAG(const char* path) { open(path); }
+        ~MappedDAG() { close(); }
+
+        MappedDAG(MappedDAG&& other) noexcept { *this = std::move(other); }
+        MappedDAG& operator=(MappedDAG&& other) noexcept {
+            if (this != &other) {
+                close();
+                offsets = std::exchange(other.offsets, {});
+                targets = std::exchange(other.targets, {});
+                flags = std::exchange(other.flags, {});
+                nodeData = std::exchange(other.nodeData, nullptr);
+                base = std::exchange(other.base, nullptr);
+                length = std::exchange(other.length, 0);
+#ifdef _WIN32
+                file = std::exchange(other.file, INVALID_HANDLE_VALUE);
+                mapping = std::exchange(other.mapping, nullptr);
+#endif
+                lastError = other.lastError;
+            }
+            return *this;
+        }
+
+        MappedDAG(const MappedDAG&) = delete;
+        MappedDAG& operator=(const MappedDAG&) = delete;
+
+        bool open(const char* path) {
+            close();
+            if (!map(path)) return false;
+
+            FileHeader header;
+            if (length < sizeof(header)) return fail("Truncated file");
+            std::memcpy(&header, base, sizeof(header));
+            if (auto message = detail::checkHeader<T>(header)) return fail(message);
+            const detail::FileLayout layout(header);
+            if (length < layout.end) return fail("Truncated file");
+
+            auto bytes = static_cast<const unsigned char*>(base);
+            offsets = { reinterpret_cast<const DagIndexType*>(bytes + layout.offsets), header.nodeCount + 1 };
+            targets = { reinterpret_cast<const DagIndexType*>(bytes + layout.targets), header.edgeCount };
+            flags = { reinterpret_cast<const DagEdgeFlags*>(bytes + layout.flags), header.edgeCount };
+            if (offsets.front() != 0 || offsets.back() != header.edgeCount) return fail("Corrupt offsets");
+            if constexpr (!std::is_void_v<T>) nodeData = reinterpret_cast<const T*>(bytes + layout.data);
+            return true;
+        }
+
+        void close() {
+            if (base) unmap();
+            offsets = {};
+            targets = {};
+            flags = {};
+            nodeData = nullptr;
+        }
+
+        bool isOpen() const { return base != nullptr; }
+
+        DagIndexType nodeCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+        DagIndexType edgeCount() const { return targets.size(); }
+        DagIndexType size() const { return nodeCount(); }
+
+        template<typename U = T> requires (!std::is_void_v<U>)
+        const U& data(DagIndexType node) const { return nodeData[node]; }
+
+        std::span<const DagIndexType> successors(DagIndexType node) const {
+            return targets.subspan(offsets[node], offsets[node + 1] - offsets[node]);
+        }
+
+        // Calls fn(to, flags) for every outgoing edge of `from`.
+        template<typename Fn>
+        void forEachEdge(DagIndexType from, Fn&& fn) const {
+            for (DagIndexType e = offsets[from]; e < offsets[from + 1]; e++) fn(targets[e], flags[e]);
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Filter&& edgeFilter = {}) const {
+            return detail::reachable(*this, from, target, edgeFilter);
+        }
+
+        template<typename Filter = NoFilter>
+        bool reachable(DagIndexType from, DagIndexType target, Workspace& ws, Filter&& edgeFilter = {}) const {
+            return detail::reachable(*this, from, target, ws, edgeFilter);
+        }
+
+        template<typename Filter = NoFilter>
+        std::vector<DagIndexType> topologicalSort(Filter&& edgeFilter = {}) const {
+            return detail::topologicalSort(*this, edgeFilter);
+        }
+
+        // Result is ws.order, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const std::vector<DagIndexType>& topologicalSort(Workspace& ws, Filter&& edgeFilter = {}) const {
+            detail::topologicalSort(*this, edgeFilter, ws.indegree, ws.order);
+            return ws.order;
+        }
+
+        template<typename Filter = NoFilter>
+        TopologicalLevels topologicalLevels(Filter&& edgeFilter = {}) const {
+            return detail::topologicalLevels(*this, edgeFilter);
+        }
+
+        // Result is ws.levels, valid until the workspace's next query.
+        template<typename Filter = NoFilter>
+        const TopologicalLevels& topologicalLevels(Workspace& ws, Filter&& edgeFilter = {}) const {
+            detail::topologicalLevels(*this, edgeFilter, ws.indegree, ws.levels);
+            return ws.levels;
+        }
+
+        template<typename Filter = NoFilter>
+        std::vector<std::vector<DagIndexType>> transitivelyReducePerNode(Filter&& edgeFilter = {}) const {
+            std::vector<std::vector<DagIndexType>> reducedEdges(nodeCount());
+            detail::transitivelyReduce(*this, reducedEdges, edgeFilter);
+            return reducedEdges;
+        }
+
+    private:
+        const T* nodeData = nullptr;
+        const void* base = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+
+        bool fail(const char* message) {
+            close();
+            lastError = message;
+            return false;
+        }
+
+#ifdef _WIN32
+        bool map(const char* path) {
+            file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) { lastError = "Cannot open file"; return false; }
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+                CloseHandle(file);
+                file = INVALID_HANDLE_VALUE;
+                lastError = "Truncated file";
+                return false;
+            }
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            if (!base) {
+                if (mapping) CloseHandle(mapping);
+                CloseHandle(file);
+                mapping = nullptr;
+                file = INVALID_HANDLE_VALUE;
+                lastError = "Cannot map file";
+                return false;
+            }
+            length = static_cast<size_t>(size.QuadPart);
+            return true;
+        }
+
+        void unmap() {
+            UnmapViewOfFile(const_cast<void*>(base));
+            CloseHandle(mapping);
+            CloseHandle(file);
+            base = nullptr;
+            length = 0;
+            mapping = nullptr;
+            file = INVALID_HANDLE_VALUE;
+        }
+#else
+        bool map(const char* path) {
+            const int fd = ::open(path, O_RDONLY);
+            if (fd < 0) { lastError = "Cannot open file"; return false; }
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size == 0) {
+                ::close(fd);
+                lastError = "Truncated file";
+                return false;
+            }
+            void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd); // the mapping keeps the file referenced
+            if (address == MAP_FAILED) { lastError = "Cannot map file"; return false; }
+            base = address;
+            length = static_cast<size_t>(info.st_size);
+            return true;
+        }
+
+        void unmap() {
+            munmap(const_cast<void*>(base), length);
+            base = nullptr;
+            length = 0;
+        }
+#endif
+    };
+
+} // namespace dag
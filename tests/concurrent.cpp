@@ -0,0 +1,76 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "dag-tests.h"
+
+using namespace dag;
+
+namespace {
+    void snapshotsAreStable() {
+        ConcurrentDAG<int> c;
+        DAG_CHECK(c.snapshot()->nodeCount() == 0);
+        for (int i = 0; i < 3; i++) c.addNode(i);
+        c.addEdge(0, 1);
+        c.publish();
+        auto before = c.snapshot();
+
+        c.addEdge(1, 2);
+        DAG_CHECK(!c.snapshot()->reachable(0, 2));
+        c.publish();
+        DAG_CHECK(c.snapshot()->reachable(0, 2));
+        DAG_CHECK(before->nodeCount() == 3 && !before->reachable(0, 2));
+    }
+
+    void writerRejectionsAndUpdates() {
+        ConcurrentDAG<int> c;
+        c.buildSnapshotPredecessors(true);
+        c.addNode(1);
+        c.addNode(2);
+        c.addEdge(0, 1);
+        const auto version = c.version();
+        DAG_CHECK(!c.update([](DynamicDAG<int>& g) { return g.addEdge(1, 0); }));
+        c.update([](DynamicDAG<int>& g) { g.addNode(3); });
+        DAG_CHECK(c.version() > version);
+
+        auto s = c.snapshot();
+        Workspace ws;
+        DAG_CHECK(s->nodeCount() == 3 && s->nodes[2].data == 3);
+        DAG_CHECK(s->hasPredecessors() && s->reachableBidirectional(0, 1, ws));
+    }
+
+    void readersDuringPublishes() {
+        ConcurrentDAG<void> c;
+        const int n = 300;
+        for (int i = 0; i < n; i++) c.addNode();
+        c.publish();
+
+        std::atomic<bool> stop{ false };
+        std::atomic<int> broken{ 0 };
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; r++) {
+            readers.emplace_back([&] {
+                Workspace ws;
+                while (!stop) {
+                    auto s = c.snapshot();
+                    if (s->topologicalSort(ws).size() != s->nodeCount()) broken++;
+                }
+            });
+        }
+        for (int i = 0; i + 1 < n; i++) {
+            c.addEdge(i, i + 1);
+            if (i % 20 == 0) c.publish();
+        }
+        c.publish();
+        stop = true;
+        for (auto& reader : readers) reader.join();
+
+        DAG_CHECK(broken == 0);
+        DAG_CHECK(c.snapshot()->reachable(0, n - 1));
+    }
+}
+
+void testConcurrent() {
+    snapshotsAreStable();
+    writerRejectionsAndUpdates();
+    readersDuringPublishes();
+}
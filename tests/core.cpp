@@ -0,0 +1,274 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "dag-tests.h"
+
+using namespace dag;
+
+namespace {
+    constexpr bool constexprGraph() {
+        StaticDAG<int, 8, 16> g;
+        for (int i = 0; i < 4; i++) g.addNode(i);
+        g.addEdge(0, 1, 1);
+        g.addEdge(1, 2, 2);
+        g.addEdge(2, 3, 3);
+        return !g.addEdge(3, 0) && g.reachable(0, 3) && g.reachable(0, 3, FlagMask::anyOf(3)) && !g.reachable(0, 3, FlagMask::allOf(1));
+    }
+    static_assert(constexprGraph());
+
+    // Diamond 0 -> {1, 2} -> 3 plus a lone node 4; edge 0 -> 2 carries flag 1.
+    template<typename G>
+    void buildDiamond(G& g) {
+        for (int i = 0; i < 5; i++) g.addNode();
+        g.addEdge(0, 1);
+        g.addEdge(0, 2, 1);
+        g.addEdge(1, 3);
+        g.addEdge(2, 3);
+    }
+
+    template<typename G>
+    void checkCycleRejection(G& g) {
+        buildDiamond(g);
+        DAG_CHECK(!g.addEdge(3, 0));
+        DAG_CHECK(g.lastError == describe(Rejection::Cycle));
+        DAG_CHECK(!g.addEdge(0, 9));
+        DAG_CHECK(g.lastError == describe(Rejection::InvalidNode));
+        DAG_CHECK(g.topologicalSort().size() == 5);
+        DAG_CHECK(g.topologicalLevels().levelCount() == 3);
+    }
+
+    void cycleRejection() {
+        StaticDAG<void, 8, 8> s;
+        checkCycleRejection(s);
+        DynamicDAG<void> d;
+        checkCycleRejection(d);
+    }
+
+    template<typename G>
+    void checkUncheckedCycle(G& g) {
+        for (int i = 0; i < 3; i++) g.addNode();
+        g.enableIncrementalOrder();
+        DAG_CHECK(g.addEdge(0, 1) && g.addEdge(1, 2));
+        DAG_CHECK(g.addEdgeUnchecked(2, 0));
+        DAG_CHECK(!g.incrementalOrderEnabled());
+        DAG_CHECK(g.topologicalSort().size() < 3);
+    }
+
+    void uncheckedEdgesDisableIncrementalOrder() {
+        StaticDAG<void, 8, 8> s;
+        checkUncheckedCycle(s);
+        DynamicDAG<void> d;
+        checkUncheckedCycle(d);
+    }
+
+    void handlesAndIndexGenerations() {
+        StaticDAG<void, 8, 8, DagEdgeFlags, CountingStats> g;
+        for (int i = 0; i < 4; i++) g.addNode();
+        g.addEdge(0, 1);
+        g.addEdge(1, 2);
+        auto old = g.handle(1);
+        ReachabilityIndex index(g);
+        DAG_CHECK(index.isCurrent(g) && index.reachable(0, 2));
+
+        g.removeNode(1);
+        DAG_CHECK(!index.isCurrent(g));
+        DAG_CHECK(g.addNode() == 1);
+        DAG_CHECK(!g.contains(old) && g.contains(g.handle(1)));
+        DAG_CHECK(!index.addEdge(g, 1, 3));
+        DAG_CHECK(g.lastError == describe(Rejection::StaleHandle));
+        DAG_CHECK(g.stats().rejected(Rejection::StaleHandle) == 1);
+
+        index.build(g);
+        DAG_CHECK(index.isCurrent(g) && !index.reachable(0, 2));
+        DAG_CHECK(index.addEdge(g, 1, 3) && index.reachable(1, 3));
+        DAG_CHECK(!index.addEdge(g, 3, 1) && g.stats().rejected(Rejection::Cycle) == 1);
+    }
+
+    void flagViews() {
+        DynamicDAG<void> d;
+        buildDiamond(d);
+        d.addEdge(1, 4, 3);
+        DAG_CHECK(FlagMask::anyOf(1).matches(3) && !FlagMask::allOf(2).matches(1) && FlagMask{}.matches(0));
+        DAG_CHECK(d.reachable(0, 2, FlagMask::allOf(1)) && !d.reachable(0, 3, FlagMask::allOf(1)));
+        DAG_CHECK(d.reachable(1, 4, FlagMask::allOf(3)) && !d.reachable(0, 4, FlagMask::anyOf(1)));
+
+        FlagViews views(d);
+        const auto& flagged = views.view(FlagMask::anyOf(1));
+        DAG_CHECK(&flagged == &views.view(FlagMask::anyOf(1)));
+        DAG_CHECK(flagged.nodeCount() == 5 && flagged.edgeCount() == 2);
+        DAG_CHECK(flagged.reachable(0, 2) && !flagged.reachable(0, 1) && !flagged.reachable(2, 3));
+        DAG_CHECK(filteredView(d, FlagMask::anyOf(1)).topologicalSort() == d.topologicalSort(FlagMask::anyOf(1)));
+        DAG_CHECK(views.cachedCount() == 1);
+        views.invalidate();
+        DAG_CHECK(views.cachedCount() == 0);
+    }
+
+    void reachableSets() {
+        DenseBitset a(130), b(130);
+        a.set(0);
+        a.set(64);
+        a.set(129);
+        b.set(64);
+        DAG_CHECK(a.count() == 3);
+        a -= b;
+        DAG_CHECK(a.count() == 2 && !a.test(64) && a.test(129));
+
+        // A wide fan-out makes the frontier large enough for bottom-up levels once predecessor
+        // lists exist; the result must not depend on them.
+        DynamicDAG<void> d;
+        const DagIndexType n = 2000;
+        for (DagIndexType i = 0; i < n; i++) d.addNode();
+        for (DagIndexType i = 1; i < n / 2; i++) d.addEdgeUnchecked(0, i);
+        for (DagIndexType i = 1; i < n / 2; i++) d.addEdgeUnchecked(i, n / 2 + i % (n / 4));
+        std::vector<DagIndexType> sources{ 0 };
+        Workspace ws;
+        const auto pushed = reachableSet(d, sources, ws).count();
+        d.enablePredecessors();
+        DAG_CHECK(reachableSet(d, sources, ws).count() == pushed);
+        DAG_CHECK(pushed == n / 2 + n / 4);
+        DAG_CHECK(!reachableSet(d, sources, ws).test(n - 1));
+    }
+
+    void traversals() {
+        DynamicDAG<int> d;
+        for (int i = 0; i < 5; i++) d.addNode(i * 10);
+        d.addEdge(0, 1);
+        d.addEdge(0, 2, 1);
+        d.addEdge(1, 3);
+        d.addEdge(2, 3);
+        std::vector<DagIndexType> from{ 1 }, to{ 3 };
+        DAG_CHECK((descendants(d, from) == std::vector<DagIndexType>{ 1, 3 }));
+        DAG_CHECK((ancestors(d, to) == std::vector<DagIndexType>{ 0, 1, 2, 3 }));
+
+        Workspace ws;
+        int seen = 0;
+        std::vector<DagIndexType> root{ 0 };
+        DAG_CHECK(!forEachDescendant(d, root, ws, [&](DagIndexType) { return ++seen < 2; }));
+        DAG_CHECK(seen == 2);
+
+        auto needs = ancestors(d, to);
+        auto sub = extractSubgraph(d, needs, [](DagIndexType, DagIndexType, DagEdgeFlags flags) { return flags == 0; });
+        DAG_CHECK(sub.graph.size() == 4 && sub.graph.nodes[3].data == 30);
+        DAG_CHECK((sub.original == std::vector<DagIndexType>{ 0, 1, 2, 3 }));
+        DAG_CHECK(!sub.graph.reachable(0, 2) && sub.graph.reachable(0, 3));
+    }
+
+    void reorderAndCompact() {
+        DynamicDAG<int> d;
+        for (int i = 0; i < 4; i++) d.addNode(i);
+        d.addEdge(3, 1);
+        d.addEdge(1, 0);
+        d.addEdge(2, 0);
+        d.removeNode(2);
+        auto old = d.handle(3);
+        auto map = d.reorder(Ordering::Topological);
+        DAG_CHECK(map[2] == DagIndexType(-1));
+        DAG_CHECK(d.size() == 3 && d.nodes[map[3]].data == 3);
+        DAG_CHECK(d.contains(NodeHandle{ map[old.index], old.generation }));
+        for (DagIndexType u = 0; u < d.size(); u++) {
+            d.forEachEdge(u, [&](DagIndexType to, DagEdgeFlags) { DAG_CHECK(to > u); });
+        }
+    }
+
+    struct Heavy {
+        std::string text;
+        explicit Heavy(size_t n) : text(n, 'x') {}
+        Heavy(Heavy&&) = delete;
+        Heavy(const Heavy&) = delete;
+    };
+
+    struct Fussy {
+        int value;
+        explicit Fussy(int v) : value(v) {
+            if (v < 0) throw std::invalid_argument("negative");
+        }
+    };
+
+    void payloads() {
+        DynamicDAG<Fussy> d;
+        d.enablePredecessors();
+        d.emplaceNode(1);
+        bool threw = false;
+        try {
+            d.emplaceNode(-1);
+        }
+        catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        DAG_CHECK(threw && d.size() == 1);
+        d.emplaceNode(2);
+        DAG_CHECK(d.addEdge(0, 1) && d.nodes[1].data.value == 2);
+
+        // StaticDAG constructs payloads in place and only for added nodes.
+        StaticDAG<Heavy, 4, 4> s;
+        s.emplaceNode(3);
+        s.emplaceNode(5);
+        DAG_CHECK(s.nodes[1].data.text.size() == 5);
+        s.removeNode(0);
+        DAG_CHECK(s.liveNodeCount() == 1);
+
+        // freeze keeps DynamicDAG tombstones and needs no default constructor.
+        d.removeNode(0);
+        auto frozen = freeze(d);
+        DAG_CHECK(frozen.nodes.size() == 2 && frozen.nodes[1].data.value == 2);
+    }
+
+    void stats() {
+        DynamicDAG<void, CountingStats> d;
+        d.stats().timing = true;
+        buildDiamond(d);
+        DAG_CHECK(!d.addEdge(3, 0));
+        DAG_CHECK(d.stats().rejected(Rejection::Cycle) == 1);
+        DAG_CHECK(d.stats().count(Operation::AddEdge) == 5);
+
+        d.stats().reset();
+        d.topologicalSort([](DagIndexType, DagIndexType, DagEdgeFlags) { return true; });
+        DAG_CHECK(d.stats().filterCalls >= 4 && d.stats().filterCalls == d.stats().edgesScanned);
+        DAG_CHECK(d.stats().count(Operation::TopologicalSort) == 1);
+
+        DynamicDAG<void, CountingStats> grown;
+        grown.reserve(64, 128);
+        grown.stats().reset();
+        for (int i = 0; i < 64; i++) grown.addNode();
+        DAG_CHECK(grown.stats().allocations == 0);
+    }
+
+    void inlineEdges() {
+        // Fan-outs below and above the inline capacity read back the same.
+        DynamicDAG<void> d;
+        for (int i = 0; i < 20; i++) d.addNode();
+        for (int i = 1; i < 20; i++) d.addEdge(0, i, i);
+        d.addEdge(1, 2);
+        DagIndexType count = 0;
+        d.forEachEdge(0, [&](DagIndexType to, DagEdgeFlags flags) { DAG_CHECK(flags == to); count++; });
+        DAG_CHECK(count == 19);
+        auto copy = d;
+        DAG_CHECK(copy.topologicalSort() == d.topologicalSort());
+    }
+
+    void dotExport() {
+        DynamicDAG<int> d;
+        d.addNode(7);
+        d.addNode(8);
+        d.addEdge(0, 1);
+        std::ostringstream out;
+        exportToDot(d, out);
+        const auto dot = out.str();
+        DAG_CHECK(dot.find("n0 [label=\"7\"]") != std::string::npos);
+        DAG_CHECK(dot.find("n0 -> n1") != std::string::npos);
+    }
+}
+
+void testCore() {
+    cycleRejection();
+    uncheckedEdgesDisableIncrementalOrder();
+    handlesAndIndexGenerations();
+    flagViews();
+    reachableSets();
+    traversals();
+    reorderAndCompact();
+    payloads();
+    stats();
+    inlineEdges();
+    dotExport();
+}
@@ -0,0 +1,149 @@
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "dag-tests.h"
+
+using namespace dag;
+
+namespace {
+    // Stand-in for an I/O layer: co_await loop.post() resumes the coroutine on one of its threads.
+    class Loop {
+    public:
+        explicit Loop(int threads) {
+            for (int i = 0; i < threads; i++) workers.emplace_back([this] { drain(); });
+        }
+
+        ~Loop() {
+            {
+                std::lock_guard lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (auto& worker : workers) worker.join();
+        }
+
+        auto post() {
+            struct Awaiter {
+                Loop* loop;
+                bool await_ready() const { return false; }
+                void await_suspend(std::coroutine_handle<> handle) {
+                    // Once queued the coroutine may resume and free this awaiter on another thread.
+                    Loop* target = loop;
+                    {
+                        std::lock_guard lock(target->mutex);
+                        target->queue.push_back(handle);
+                    }
+                    target->wake.notify_one();
+                }
+                void await_resume() const {}
+            };
+            return Awaiter{ this };
+        }
+
+    private:
+        void drain() {
+            for (;;) {
+                std::coroutine_handle<> handle;
+                {
+                    std::unique_lock lock(mutex);
+                    wake.wait(lock, [&] { return stopping || !queue.empty(); });
+                    if (queue.empty()) return;
+                    handle = queue.front();
+                    queue.pop_front();
+                }
+                handle.resume();
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<std::coroutine_handle<>> queue;
+        bool stopping = false;
+        std::vector<std::thread> workers;
+    };
+
+    Task record(std::vector<DagIndexType>& order, DagIndexType node) {
+        order.push_back(node);
+        co_return;
+    }
+
+    void synchronousChainsDoNotNest() {
+        DynamicDAG<void> d;
+        const DagIndexType n = 100000;
+        for (DagIndexType i = 0; i < n; i++) d.addNode();
+        for (DagIndexType i = 0; i + 1 < n; i++) d.addEdgeUnchecked(i, i + 1);
+        std::vector<DagIndexType> order;
+        syncWait(runAsync(d, [&](DagIndexType node) { return record(order, node); }, 4));
+        DAG_CHECK(order.size() == n && order.front() == 0 && order.back() == n - 1);
+    }
+
+    void respectsDependenciesAndLimit() {
+        Loop loop(3);
+        DynamicDAG<void> d;
+        d.enablePredecessors();
+        for (int i = 0; i < 60; i++) d.addNode();
+        for (int i = 0; i + 6 < 60; i++) {
+            d.addEdge(i, i + 6);
+            d.addEdge(i, i + 5, 1);
+        }
+        std::vector<std::atomic<bool>> done(d.size());
+        std::atomic<int> running{ 0 }, peak{ 0 }, early{ 0 }, finished{ 0 };
+        auto node = [&](DagIndexType v) -> Task {
+            const int now = ++running;
+            for (int seen = peak; now > seen && !peak.compare_exchange_weak(seen, now);) {}
+            d.forEachInEdge(v, [&](DagIndexType from, DagEdgeFlags flags) { if (flags == 0 && !done[from]) early++; });
+            co_await loop.post();
+            --running;
+            done[v] = true;
+            finished++;
+        };
+        syncWait(runAsync(d, node, 4, [](DagIndexType, DagIndexType, DagEdgeFlags flags) { return flags == 0; }));
+        DAG_CHECK(finished == 60 && early == 0);
+        DAG_CHECK(peak <= 4);
+    }
+
+    void exceptionsReachTheAwaiter() {
+        Loop loop(2);
+        DynamicDAG<void> d;
+        for (int i = 0; i < 20; i++) d.addNode();
+        for (int i = 0; i + 1 < 20; i++) d.addEdge(i, i + 1);
+        std::atomic<int> finished{ 0 };
+        bool threw = false;
+        try {
+            syncWait(runAsync(d, [&](DagIndexType v) -> Task {
+                co_await loop.post();
+                if (v == 5) throw std::runtime_error("node failed");
+                finished++;
+            }));
+        }
+        catch (const std::runtime_error&) {
+            threw = true;
+        }
+        DAG_CHECK(threw && finished == 5);
+    }
+
+    void awaitedFromACoroutine() {
+        Loop loop(2);
+        DynamicDAG<void> d;
+        for (int i = 0; i < 50; i++) d.addNode();
+        std::atomic<int> ran{ 0 };
+        auto outer = [&]() -> Task {
+            co_await runAsync(d, [&](DagIndexType) -> Task { co_await loop.post(); ran++; }, 8);
+            co_await runAsync(d, [&](DagIndexType) -> Task { ran++; co_return; });
+        };
+        syncWait(outer());
+        DAG_CHECK(ran == 100);
+    }
+}
+
+void testCoroutine() {
+    synchronousChainsDoNotNest();
+    respectsDependenciesAndLimit();
+    exceptionsReachTheAwaiter();
+    awaitedFromACoroutine();
+}
@@ -0,0 +1,53 @@
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include "dag-tests.h"
+
+namespace {
+    int failures = 0;
+
+    struct Group {
+        const char* name;
+        void (*run)();
+    };
+
+    constexpr Group groups[] = {
+        { "core", testCore },
+        { "executor", testExecutor },
+        { "parallel", testParallel },
+        { "concurrent", testConcurrent },
+        { "incremental", testIncremental },
+        { "coroutine", testCoroutine },
+        { "paths", testPaths },
+        { "serialize", testSerialize },
+    };
+}
+
+void dagtest::fail(const char* expr, const char* file, int line) {
+    std::cerr << file << ":" << line << ": check failed: " << expr << "\n";
+    failures++;
+}
+
+// Usage: dag-tests [group...]; runs every group when none is named.
+int main(int argc, char** argv) {
+    int ran = 0;
+    for (const Group& group : groups) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; i++) selected |= std::strcmp(argv[i], group.name) == 0;
+        if (!selected) continue;
+        try {
+            group.run();
+        }
+        catch (const std::exception& e) {
+            std::cerr << group.name << ": unexpected exception: " << e.what() << "\n";
+            failures++;
+        }
+        ran++;
+    }
+    if (ran == 0) {
+        std::cerr << "no such test group\n";
+        return 2;
+    }
+    std::cout << (failures ? "FAILED" : "passed") << " (" << failures << " failed checks)\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,28 @@
+// dag-tests.h : Shared by the test groups of dag-tests.
+
+#pragma once
+
+#include <dag/dag.hpp>
+#include <dag/executor.hpp>
+#include <dag/parallel.hpp>
+#include <dag/concurrent.hpp>
+#include <dag/incremental.hpp>
+#include <dag/coroutine.hpp>
+#include <dag/paths.hpp>
+#include <dag/serialize.hpp>
+
+namespace dagtest {
+    // Reports a failed check; the group keeps running and dag-tests exits nonzero.
+    void fail(const char* expr, const char* file, int line);
+}
+
+#define DAG_CHECK(expr) ((expr) ? void() : dagtest::fail(#expr, __FILE__, __LINE__))
+
+void testCore();
+void testExecutor();
+void testParallel();
+void testConcurrent();
+void testIncremental();
+void testCoroutine();
+void testPaths();
+void testSerialize();
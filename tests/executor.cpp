@@ -0,0 +1,74 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "dag-tests.h"
+
+using namespace dag;
+
+namespace {
+    // Layers of `width` nodes, every node feeding two nodes of the next layer.
+    DynamicDAG<void> layered(DagIndexType layers, DagIndexType width) {
+        DynamicDAG<void> d;
+        d.enablePredecessors();
+        for (DagIndexType i = 0; i < layers * width; i++) d.addNode();
+        for (DagIndexType i = 0; i + width < layers * width; i++) {
+            d.addEdgeUnchecked(i, i + width);
+            d.addEdgeUnchecked(i, (i / width + 1) * width + (i + 1) % width, 1);
+        }
+        return d;
+    }
+
+    void dependenciesFinishFirst() {
+        auto d = layered(20, 16);
+        Executor executor(4);
+        DAG_CHECK(executor.threadCount() == 4);
+        std::vector<std::atomic<bool>> done(d.size());
+        std::atomic<int> early{ 0 }, ran{ 0 };
+        for (int round = 0; round < 10; round++) {
+            for (auto& flag : done) flag = false;
+            executor.run(d, [&](DagIndexType node) {
+                d.forEachInEdge(node, [&](DagIndexType from, DagEdgeFlags) { if (!done[from]) early++; });
+                done[node] = true;
+                ran++;
+            });
+        }
+        DAG_CHECK(early == 0);
+        DAG_CHECK(ran == 10 * int(d.size()));
+    }
+
+    void filteredEdgesAndRemovedNodes() {
+        auto d = layered(4, 4);
+        d.removeNode(5);
+        std::atomic<int> ran{ 0 };
+        run(d, [&](DagIndexType node) { DAG_CHECK(node != 5); ran++; }, 2, [](DagIndexType, DagIndexType, DagEdgeFlags flags) { return flags == 0; });
+        DAG_CHECK(ran == 15);
+    }
+
+    void exceptionsReachTheCaller() {
+        auto d = layered(10, 8);
+        Executor executor(3);
+        std::atomic<int> ran{ 0 };
+        bool threw = false;
+        try {
+            executor.run(d, [&](DagIndexType node) {
+                if (node == 12) throw std::runtime_error("node failed");
+                ran++;
+            });
+        }
+        catch (const std::runtime_error&) {
+            threw = true;
+        }
+        DAG_CHECK(threw && ran < int(d.size()));
+
+        // The executor stays usable after a failed run.
+        ran = 0;
+        executor.run(d, [&](DagIndexType) { ran++; });
+        DAG_CHECK(ran == int(d.size()));
+    }
+}
+
+void testExecutor() {
+    dependenciesFinishFirst();
+    filteredEdgesAndRemovedNodes();
+    exceptionsReachTheCaller();
+}
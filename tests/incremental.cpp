@@ -0,0 +1,88 @@
+#include <stdexcept>
+#include <vector>
+#include "dag-tests.h"
+
+using namespace dag;
+
+namespace {
+    // Chain 0 -> 1 -> 2 -> 3 plus 0 -> 4; a node's value is its input plus its predecessors' values.
+    struct Sums {
+        DynamicDAG<long> graph;
+        std::vector<long> input{ 1, 0, 0, 0, 0 };
+        int calls = 0;
+
+        Sums() {
+            graph.enablePredecessors();
+            for (int i = 0; i < 5; i++) graph.addNode(0);
+            graph.addEdge(0, 1);
+            graph.addEdge(1, 2);
+            graph.addEdge(2, 3);
+            graph.addEdge(0, 4);
+        }
+
+        bool evaluate(DagIndexType node, long& value) {
+            calls++;
+            long sum = input[node];
+            graph.forEachInEdge(node, [&](DagIndexType from, DagEdgeFlags) { sum += graph.nodes[from].data; });
+            const bool changed = sum != value;
+            value = sum;
+            return changed;
+        }
+    };
+
+    void recomputesDownstream() {
+        Sums s;
+        Incremental inc(s.graph);
+        auto fn = [&](DagIndexType node, long& value) { return s.evaluate(node, value); };
+        inc.markAllDirty();
+        DAG_CHECK(inc.recompute(fn) == 5);
+        DAG_CHECK(s.graph.nodes[3].data == 1 && s.graph.nodes[4].data == 1);
+
+        s.input[1] = 10;
+        DAG_CHECK(inc.markDirty(1) && inc.isDirty(1));
+        s.calls = 0;
+        inc.recompute(fn);
+        DAG_CHECK(s.calls == 3 && s.graph.nodes[3].data == 11 && s.graph.nodes[4].data == 1);
+        DAG_CHECK(inc.dirtyCount() == 0);
+    }
+
+    void stopsWhereValuesDoNotChange() {
+        Sums s;
+        Incremental inc(s.graph);
+        auto fn = [&](DagIndexType node, long& value) { return s.evaluate(node, value); };
+        inc.markAllDirty();
+        inc.recompute(fn);
+
+        s.calls = 0;
+        inc.markDirty(0);
+        DAG_CHECK(inc.recompute(fn) == 1 && s.calls == 1);
+    }
+
+    void failedRunsStayDirty() {
+        Sums s;
+        Incremental inc(s.graph);
+        inc.markAllDirty();
+        bool threw = false;
+        try {
+            inc.recompute([&](DagIndexType node, long& value) {
+                if (node == 2) throw std::runtime_error("evaluation failed");
+                return s.evaluate(node, value);
+            });
+        }
+        catch (const std::runtime_error&) {
+            threw = true;
+        }
+        DAG_CHECK(threw && inc.isDirty(2) && inc.isDirty(3));
+        inc.recompute([&](DagIndexType node, long& value) { return s.evaluate(node, value); });
+        DAG_CHECK(s.graph.nodes[3].data == 1 && !inc.isDirty(3));
+
+        s.graph.removeNode(4);
+        DAG_CHECK(!inc.markDirty(4));
+    }
+}
+
+void testIncremental() {
+    recomputesDownstream();
+    stopsWhereValuesDoNotChange();
+    failedRunsStayDirty();
+}
@@ -0,0 +1,93 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "dag-tests.h"
+
+using namespace dag;
+
+namespace {
+    // Rows of 256 nodes, large enough to take the threaded path: node i feeds the node below it
+    // (flag 0) and the one below and to the right (flag 1), so every row is one level.
+    DynamicDAG<void> grid(DagIndexType rows) {
+        constexpr DagIndexType width = 256;
+        DynamicDAG<void> d;
+        for (DagIndexType i = 0; i < rows * width; i++) d.addNode();
+        for (DagIndexType i = 0; i + width < rows * width; i++) {
+            d.addEdgeUnchecked(i, i + width);
+            d.addEdgeUnchecked(i, (i / width + 1) * width + (i + 1) % width, 1);
+        }
+        return d;
+    }
+
+    template<typename G>
+    bool isTopological(const G& g, const std::vector<DagIndexType>& order) {
+        std::vector<DagIndexType> position(g.size(), DagIndexType(-1));
+        for (DagIndexType i = 0; i < order.size(); i++) position[order[i]] = i;
+        bool ok = true;
+        for (DagIndexType u = 0; u < g.size(); u++) {
+            if (position[u] == DagIndexType(-1)) continue;
+            g.forEachEdge(u, [&](DagIndexType to, const auto&) { ok &= position[to] > position[u]; });
+        }
+        return ok;
+    }
+
+    void matchesSerialLevels() {
+        auto csr = freeze(grid(256));
+        auto parallel = parallelTopologicalLevels(csr, 4, true);
+        DAG_CHECK(parallel.levelCount() == 256 && parallel.offsets == csr.topologicalLevels().offsets);
+        std::vector<DagIndexType> everyNode(csr.size());
+        for (DagIndexType i = 0; i < csr.size(); i++) everyNode[i] = i;
+        DAG_CHECK(parallel.nodes == everyNode);
+
+        auto order = parallelTopologicalSort(csr, 3);
+        DAG_CHECK(order.size() == csr.size() && isTopological(csr, order));
+
+        auto hardOnly = [](DagIndexType, DagIndexType, DagEdgeFlags flags) { return flags == 0; };
+        DAG_CHECK(parallelTopologicalLevels(csr, 4, false, hardOnly).levelCount() == csr.topologicalLevels(hardOnly).levelCount());
+    }
+
+    void deterministicAcrossThreadCounts() {
+        auto d = grid(128);
+        auto soft = [](DagIndexType from, DagIndexType, DagEdgeFlags flags) { return flags == 0 || from % 3 == 0; };
+        auto reference = parallelTopologicalSort(d, 1, true, soft);
+        DAG_CHECK(parallelTopologicalSort(d, 2, true, soft) == reference);
+        DAG_CHECK(parallelTopologicalSort(d, 7, true, soft) == reference);
+    }
+
+    void removedNodesAndSmallGraphs() {
+        auto d = grid(128);
+        d.removeNode(100);
+        DAG_CHECK(parallelTopologicalSort(d, 4).size() == d.size() - 1);
+
+        DynamicDAG<void> small;
+        small.addNode();
+        small.addNode();
+        small.addEdge(1, 0);
+        DAG_CHECK((parallelTopologicalSort(small, 4) == std::vector<DagIndexType>{ 1, 0 }));
+    }
+
+    void filterExceptionsReachTheCaller() {
+        auto d = grid(256);
+        for (int when : { 10, 70000 }) {
+            std::atomic<int> calls{ 0 };
+            bool threw = false;
+            try {
+                parallelTopologicalLevels(d, 4, true, [&](DagIndexType, DagIndexType, DagEdgeFlags) {
+                    if (calls.fetch_add(1) == when) throw std::runtime_error("filter failed");
+                    return true;
+                });
+            }
+            catch (const std::runtime_error&) {
+                threw = true;
+            }
+            DAG_CHECK(threw);
+        }
+    }
+}
+
+void testParallel() {
+    matchesSerialLevels();
+    deterministicAcrossThreadCounts();
+    removedNodesAndSmallGraphs();
+    filterExceptionsReachTheCaller();
+}
@@ -0,0 +1,73 @@
+#include <vector>
+#include "dag-tests.h"
+
+using namespace dag;
+
+namespace {
+    // 0 -> 1 -> 3 and 0 -> 2 -> 3, node costs 1, 5, 2, 1; edge flags are edge costs.
+    template<typename G>
+    void buildPlan(G& g) {
+        for (int cost : { 1, 5, 2, 1 }) g.addNode(cost);
+        g.addEdge(0, 1, 0);
+        g.addEdge(0, 2, 1);
+        g.addEdge(1, 3, 0);
+        g.addEdge(2, 3, 4);
+    }
+
+    void longestAndShortest() {
+        DynamicDAG<int> d;
+        buildPlan(d);
+        d.addNode(9);
+        auto cost = [&](DagIndexType node) { return d.nodes[node].data; };
+        auto edgeCost = [](DagIndexType, DagIndexType, DagEdgeFlags flags) { return int(flags); };
+        std::vector<DagIndexType> sources{ 0 };
+
+        auto longest = longestPaths(d, sources, cost, edgeCost);
+        DAG_CHECK(longest.distance[3] == 9);
+        DAG_CHECK((longest.pathTo(3) == std::vector<DagIndexType>{ 0, 2, 3 }));
+        DAG_CHECK(!longest.reached.test(4) && longest.pathTo(4).empty());
+
+        auto shortest = shortestPaths(d, sources, cost, edgeCost);
+        DAG_CHECK(shortest.distance[3] == 7);
+        DAG_CHECK((shortest.pathTo(3) == std::vector<DagIndexType>{ 0, 1, 3 }));
+
+        auto hops = longestPaths(d, sources, NoCost{}, [](DagIndexType, DagIndexType, DagEdgeFlags) { return 1; });
+        DAG_CHECK(hops.distance[3] == 2);
+
+        auto direct = longestPaths(d, sources, cost, edgeCost, [](DagIndexType, DagIndexType to, DagEdgeFlags) { return to != 2; });
+        DAG_CHECK(direct.distance[3] == 7 && !direct.reached.test(2));
+    }
+
+    void criticalPathSchedule() {
+        StaticDAG<int, 8, 8> s;
+        buildPlan(s);
+        auto plan = criticalPath(s, [&](DagIndexType node) { return s.nodes[node].data; }, [](DagIndexType, DagIndexType, const auto& edge) { return int(edge.flags); });
+        DAG_CHECK(plan.length == 9);
+        DAG_CHECK(plan.earliestStart[3] == 8 && plan.earliestStart[2] == 2);
+        DAG_CHECK(plan.slack(2) == 0 && plan.slack(1) == 2);
+        DAG_CHECK((plan.path == std::vector<DagIndexType>{ 0, 2, 3 }));
+    }
+
+    void reusesBuffers() {
+        DynamicDAG<int> d;
+        buildPlan(d);
+        auto csr = freeze(d);
+        auto half = [&](DagIndexType node) { return csr.nodes[node].data * 0.5; };
+        Workspace ws;
+        CriticalPath<double> plan;
+        criticalPath(csr, plan, ws, half);
+        const auto first = plan.length;
+        criticalPath(csr, plan, ws, half);
+        DAG_CHECK(plan.length == first && first == 3.5);
+
+        DynamicDAG<void> empty;
+        auto none = criticalPath(empty);
+        DAG_CHECK(none.length == 0 && none.path.empty());
+    }
+}
+
+void testPaths() {
+    longestAndShortest();
+    criticalPathSchedule();
+    reusesBuffers();
+}
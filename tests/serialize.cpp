@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "dag-tests.h"
+
+using namespace dag;
+
+namespace {
+    struct Point {
+        int id;
+        double weight;
+    };
+
+    DynamicDAG<Point> sample() {
+        DynamicDAG<Point> g;
+        for (int i = 0; i < 100; i++) g.addNode({ i, i * 0.5 });
+        for (int i = 0; i + 1 < 100; i++) {
+            g.addEdge(i, i + 1, i % 3);
+            if (i + 7 < 100) g.addEdge(i, i + 7, 1);
+        }
+        return g;
+    }
+
+    std::string writeFile(const std::string& name, const std::string& bytes) {
+        const auto path = (std::filesystem::temp_directory_path() / name).string();
+        std::ofstream(path, std::ios::binary) << bytes;
+        return path;
+    }
+
+    void streamRoundTrip() {
+        auto g = sample();
+        std::stringstream buffer;
+        DAG_CHECK(save(g, buffer));
+        CsrDAG<Point> loaded;
+        const char* error = nullptr;
+        DAG_CHECK(load(buffer, loaded, &error) && error == nullptr);
+        DAG_CHECK(loaded.nodeCount() == 100 && loaded.nodes[42].data.weight == 21.0);
+        DAG_CHECK(loaded.topologicalSort() == g.topologicalSort());
+        DAG_CHECK(loaded.reachable(0, 99, [](DagIndexType, DagIndexType, DagEdgeFlags flags) { return flags == 1; }) == g.reachable(0, 99, FlagMask::allOf(1)));
+
+        StaticDAG<int, 4, 4> s;
+        s.addNode(1);
+        s.addNode(2);
+        s.addEdge(0, 1);
+        std::stringstream small;
+        CsrDAG<int> fromStatic;
+        DAG_CHECK(save(s, small) && load(small, fromStatic) && fromStatic.nodes[1].data == 2);
+    }
+
+    void mappedFiles() {
+        std::ostringstream bytes;
+        save(sample(), bytes);
+        const auto path = writeFile("dag-tests-mapped.bin", bytes.str());
+
+        MappedDAG<Point> mapped(path.c_str());
+        DAG_CHECK(mapped.isOpen() && !mapped.lastError);
+        DAG_CHECK(mapped.nodeCount() == 100 && mapped.data(50).id == 50);
+        DAG_CHECK(mapped.topologicalSort() == sample().topologicalSort());
+
+        MappedDAG<int> wrongType(path.c_str());
+        DAG_CHECK(!wrongType.isOpen() && std::string(wrongType.lastError) == "Node data type mismatch");
+        const auto absent = (std::filesystem::temp_directory_path() / "dag-tests-missing.bin").string();
+        MappedDAG<> missing(absent.c_str());
+        DAG_CHECK(!missing.isOpen());
+        std::filesystem::remove(path);
+    }
+
+    void corruptHeadersAreRejected() {
+        DynamicDAG<int> g;
+        for (int i = 0; i < 5; i++) g.addNode(i);
+        g.addEdge(0, 1);
+        g.addEdge(3, 4);
+        std::ostringstream os;
+        save(g, os);
+        const std::string good = os.str();
+
+        auto loads = [&](uint64_t nodes, uint64_t edges) {
+            std::string bytes = good;
+            FileHeader header;
+            std::memcpy(&header, bytes.data(), sizeof header);
+            header.nodeCount = nodes;
+            header.edgeCount = edges;
+            std::memcpy(bytes.data(), &header, sizeof header);
+            std::istringstream in(bytes);
+            CsrDAG<int> csr;
+            const bool streamed = load(in, csr);
+            const auto path = writeFile("dag-tests-corrupt.bin", bytes);
+            MappedDAG<int> mapped;
+            const bool opened = mapped.open(path.c_str());
+            std::filesystem::remove(path);
+            DAG_CHECK(streamed == opened);
+            return streamed;
+        };
+        DAG_CHECK(loads(5, 2));
+        DAG_CHECK(!loads(UINT64_MAX, 2));
+        DAG_CHECK(!loads(5, uint64_t(1) << 40));
+        DAG_CHECK(!loads(5, UINT64_MAX / 4 + 1));
+        DAG_CHECK(!loads(6, 2));
+    }
+}
+
+void testSerialize() {
+    streamRoundTrip();
+    mappedFiles();
+    corruptHeadersAreRejected();
+}